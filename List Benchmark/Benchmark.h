@@ -0,0 +1,258 @@
+#pragma once
+
+#include<algorithm>
+#include<chrono>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<functional>
+#include<string>
+#include<vector>
+
+namespace Benchmark
+{
+	/// <summary>
+	/// <para>A single measurement, one row of the CSV output or one object of the JSON output.</para>
+	/// </summary>
+	struct Result
+	{
+		std::string suite;
+		std::string operation;
+		std::string element;
+		std::string container;
+		size_t size;
+		size_t repetitions;
+		double totalNanoseconds;
+		double nanosecondsPerElement;
+	};
+
+	struct Options
+	{
+		size_t minimumSize = 16;
+		size_t maximumSize = 100000000;
+		size_t maximumQuadraticSize = 100000; // Prepend/Insert/Delete one by one are O(n^2) for both containers.
+		double minimumSeconds = 0.05; // Repeat small cases until at least this long has been measured.
+		std::string format = "csv";
+		std::string filter;
+		std::string output;
+	};
+
+	/// <summary>
+	/// <para>An element with a user-provided copy constructor, so List classifies it as Generic and std::vector cannot memcpy it.</para>
+	/// <para>It owns no memory, so the measurements show the per-element paths rather than the heap.</para>
+	/// </summary>
+	struct Generic
+	{
+		size_t value;
+
+		Generic(size_t value = 0) :value(value) {}
+		Generic(const Generic& other) :value(other.value) {}
+		Generic& operator=(const Generic& other) { value = other.value; return *this; }
+		~Generic() {}
+
+		bool operator==(const Generic& other)const { return value == other.value; }
+		bool operator<(const Generic& other)const { return value < other.value; }
+	};
+
+	class Context;
+	using SuiteFunction = std::function<void(Context&)>;
+
+	struct Suite
+	{
+		const char* name;
+		SuiteFunction function;
+	};
+
+	inline std::vector<Suite>& GetSuites()
+	{
+		static std::vector<Suite> suites;
+		return suites;
+	}
+
+	/// <summary>
+	/// <para>Registers a suite at static initialization time, one per translation unit is the usual layout.</para>
+	/// </summary>
+	struct Registrar
+	{
+		Registrar(const char* name, SuiteFunction function) { GetSuites().push_back({ name, std::move(function) }); }
+	};
+
+	/// <summary>
+	/// <para>Keeps the optimizer from discarding a computed value or the stores behind a pointer.</para>
+	/// </summary>
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	class Context
+	{
+	private:
+		const Options& options;
+		std::vector<Result>& results;
+		const char* suite;
+
+	public:
+		Context(const Options& options, std::vector<Result>& results, const char* suite)
+			:options(options), results(results), suite(suite)
+		{}
+
+		const Options& GetOptions()const { return options; }
+
+		/// <summary>
+		/// <para>The geometric series of sizes between the configured bounds: 16, 128, 1024, 10^4 ... 10^9.</para>
+		/// </summary>
+		/// <param name="quadratic">whether the measured operation is O(n^2) and must respect the lower bound</param>
+		/// <returns></returns>
+		std::vector<size_t> GetSizes(bool quadratic = false)const
+		{
+			static const size_t series[] = { 16, 128, 1024, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+			size_t upper = quadratic ? std::min(options.maximumSize, options.maximumQuadraticSize) : options.maximumSize;
+
+			std::vector<size_t> sizes;
+			for (size_t size : series)
+				if (size >= options.minimumSize && size <= upper)
+					sizes.push_back(size);
+			return sizes;
+		}
+
+		/// <summary>
+		/// <para>Times [body], which must process [size] elements, repeating it until the minimum duration is reached.</para>
+		/// <para>[setup] runs before every repetition and is not measured.</para>
+		/// </summary>
+		void Measure(const char* operation, const char* element, const char* container, size_t size,
+			const std::function<void()>& setup, const std::function<void()>& body)
+		{
+			std::string name = std::string(suite) + "/" + operation + "/" + element + "/" + container;
+			if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+				return;
+
+			using Clock = std::chrono::steady_clock;
+
+			size_t repetitions = 0;
+			double total = 0;
+			do
+			{
+				setup();
+				Clock::time_point begin = Clock::now();
+				body();
+				Clock::time_point end = Clock::now();
+
+				total += std::chrono::duration<double, std::nano>(end - begin).count();
+				++repetitions;
+			} while (total < options.minimumSeconds * 1e9);
+
+			results.push_back({ suite, operation, element, container, size, repetitions, total, total / ((double)repetitions * (double)(size ? size : 1)) });
+			std::fprintf(stderr, "%-60s %12zu %12.3f ns/element\n", name.c_str(), size, results.back().nanosecondsPerElement);
+		}
+
+		void Measure(const char* operation, const char* element, const char* container, size_t size,
+			const std::function<void()>& body)
+		{
+			Measure(operation, element, container, size, [] {}, body);
+		}
+	};
+
+	inline void WriteCsv(std::FILE* file, const std::vector<Result>& results)
+	{
+		std::fprintf(file, "suite,operation,element,container,size,repetitions,total_ns,ns_per_element\n");
+		for (const Result& result : results)
+			std::fprintf(file, "%s,%s,%s,%s,%zu,%zu,%.0f,%.4f\n",
+				result.suite.c_str(), result.operation.c_str(), result.element.c_str(), result.container.c_str(),
+				result.size, result.repetitions, result.totalNanoseconds, result.nanosecondsPerElement);
+	}
+
+	inline void WriteJson(std::FILE* file, const std::vector<Result>& results)
+	{
+		std::fprintf(file, "[\n");
+		for (size_t index = 0; index < results.size(); ++index)
+		{
+			const Result& result = results[index];
+			std::fprintf(file, "  {\"suite\": \"%s\", \"operation\": \"%s\", \"element\": \"%s\", \"container\": \"%s\", "
+				"\"size\": %zu, \"repetitions\": %zu, \"total_ns\": %.0f, \"ns_per_element\": %.4f}%s\n",
+				result.suite.c_str(), result.operation.c_str(), result.element.c_str(), result.container.c_str(),
+				result.size, result.repetitions, result.totalNanoseconds, result.nanosecondsPerElement,
+				index + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "]\n");
+	}
+
+	inline bool ParseOption(const char* argument, const char* name, std::string& value)
+	{
+		size_t length = std::strlen(name);
+		if (std::strncmp(argument, name, length) || argument[length] != '=')
+			return false;
+
+		value = argument + length + 1;
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Parses the command line, runs every registered suite and writes the results.</para>
+	/// <para>--format=csv|json --output=file --filter=substring --min-size=n --max-size=n --max-quadratic-size=n --min-time=seconds</para>
+	/// </summary>
+	inline int Run(int argc, char** argv)
+	{
+		Options options;
+		for (int index = 1; index < argc; ++index)
+		{
+			std::string value;
+			if (ParseOption(argv[index], "--format", value))
+				options.format = value;
+			else if (ParseOption(argv[index], "--output", value))
+				options.output = value;
+			else if (ParseOption(argv[index], "--filter", value))
+				options.filter = value;
+			else if (ParseOption(argv[index], "--min-size", value))
+				options.minimumSize = std::strtoull(value.c_str(), nullptr, 10);
+			else if (ParseOption(argv[index], "--max-size", value))
+				options.maximumSize = std::strtoull(value.c_str(), nullptr, 10);
+			else if (ParseOption(argv[index], "--max-quadratic-size", value))
+				options.maximumQuadraticSize = std::strtoull(value.c_str(), nullptr, 10);
+			else if (ParseOption(argv[index], "--min-time", value))
+				options.minimumSeconds = std::strtod(value.c_str(), nullptr);
+			else
+			{
+				std::fprintf(stderr, "usage: %s [--format=csv|json] [--output=file] [--filter=substring] "
+					"[--min-size=n] [--max-size=n] [--max-quadratic-size=n] [--min-time=seconds]\n", argv[0]);
+				return 1;
+			}
+		}
+
+		if (options.format != "csv" && options.format != "json")
+		{
+			std::fprintf(stderr, "unknown format: %s\n", options.format.c_str());
+			return 1;
+		}
+
+		std::vector<Result> results;
+		for (Suite& suite : GetSuites())
+		{
+			Context context(options, results, suite.name);
+			suite.function(context);
+		}
+
+		std::FILE* file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+		if (!file)
+		{
+			std::fprintf(stderr, "cannot open %s\n", options.output.c_str());
+			return 1;
+		}
+
+		if (options.format == "json")
+			WriteJson(file, results);
+		else
+			WriteCsv(file, results);
+
+		if (file != stdout)
+			std::fclose(file);
+		return 0;
+	}
+}
@@ -0,0 +1,128 @@
+// ConcurrentBenchmark.cpp : many threads sharing one list, or appending to one, at once.
+//
+
+#include<mutex>
+#include<string>
+#include<thread>
+#include<vector>
+#include"Benchmark.h"
+#include"ConcurrentAppendList.h"
+#include"List.h"
+
+namespace
+{
+	const unsigned ThreadCounts[] = { 1, 2, 4, 8, 16 };
+	const char* const ThreadNames[] = { "1 thread", "2 threads", "4 threads", "8 threads", "16 threads" };
+
+	/// <summary>
+	/// <para>Run [work] on [threadCount] threads, each taking its share of [size] iterations.</para>
+	/// </summary>
+	template<typename Work>
+	void RunThreads(unsigned threadCount, size_t size, const Work& work)
+	{
+		std::vector<std::thread> threads;
+		for (unsigned thread = 0; thread < threadCount; ++thread)
+			threads.emplace_back([&, thread] { work(size / threadCount + (thread < size % threadCount)); });
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	/// <summary>
+	/// <para>Every thread hammers the reference count of one block, [size] copies in all, so ns/element falls as long as the cores scale.</para>
+	/// <para>The thread counts stop at twice the cores, the sizes below 10^4 would mostly measure the thread creation.</para>
+	/// </summary>
+	void Run(Benchmark::Context& context)
+	{
+		List<int> source(64, ListFill, 1);
+		unsigned cores = std::thread::hardware_concurrency();
+
+		for (size_t size : context.GetSizes())
+		{
+			if (size < 10000)
+				continue;
+
+			for (size_t index = 0; index < sizeof(ThreadCounts) / sizeof(*ThreadCounts); ++index)
+			{
+				unsigned threadCount = ThreadCounts[index];
+				if (threadCount > 1 && cores && threadCount > cores * 2)
+					break;
+
+				context.Measure("CopyDestroy", "int", ThreadNames[index], size, [&]
+					{
+						RunThreads(threadCount, size, [&](size_t count)
+							{
+								for (size_t iteration = 0; iteration < count; ++iteration)
+								{
+									List<int> copy(source);
+									Benchmark::DoNotOptimize(copy.GetConstData());
+								}
+							});
+					});
+
+				// Every copy is changed, so it detaches while the other threads still share the block.
+				context.Measure("CopyDetach", "int", ThreadNames[index], size, [&]
+					{
+						RunThreads(threadCount, size, [&](size_t count)
+							{
+								for (size_t iteration = 0; iteration < count; ++iteration)
+								{
+									List<int> copy(source);
+									copy.Append(1);
+									Benchmark::DoNotOptimize(copy.GetConstData());
+								}
+							});
+					});
+
+				std::string appendList = std::string("ConcurrentAppendList/") + ThreadNames[index];
+				context.Measure("Append", "int", appendList.c_str(), size, [&]
+					{
+						ConcurrentAppendList<int> buffer(size);
+						RunThreads(threadCount, size, [&](size_t count)
+							{
+								for (size_t iteration = 0; iteration < count; ++iteration)
+									buffer.Append((int)iteration);
+							});
+						Benchmark::DoNotOptimize(buffer.Seal().GetConstData());
+					});
+
+				// Producers that gather 64 results before publishing them, one reservation per batch.
+				std::string batchList = std::string("ConcurrentAppendList batch/") + ThreadNames[index];
+				context.Measure("Append", "int", batchList.c_str(), size, [&]
+					{
+						ConcurrentAppendList<int> buffer(size);
+						RunThreads(threadCount, size, [&](size_t count)
+							{
+								int batch[64];
+								for (size_t iteration = 0; iteration < count; iteration += 64)
+								{
+									size_t batchSize = count - iteration < 64 ? count - iteration : 64;
+									for (size_t offset = 0; offset < batchSize; ++offset)
+										batch[offset] = (int)(iteration + offset);
+									buffer.Append(batch, batchSize);
+								}
+							});
+						Benchmark::DoNotOptimize(buffer.Seal().GetConstData());
+					});
+
+				std::string mutexList = std::string("mutex List/") + ThreadNames[index];
+				context.Measure("Append", "int", mutexList.c_str(), size, [&]
+					{
+						List<int> list;
+						std::mutex mutex;
+						RunThreads(threadCount, size, [&](size_t count)
+							{
+								for (size_t iteration = 0; iteration < count; ++iteration)
+								{
+									std::lock_guard<std::mutex> lock(mutex);
+									list.Append((int)iteration);
+								}
+							});
+						Benchmark::DoNotOptimize(list.GetConstData());
+					});
+			}
+		}
+	}
+
+	Benchmark::Registrar registrar("Concurrent", Run);
+}
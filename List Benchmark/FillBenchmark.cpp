@@ -0,0 +1,69 @@
+// FillBenchmark.cpp : bulk fills through List(size, ListFill, value) and Append(value, count) against std::vector.
+//
+
+#include<vector>
+#include"Benchmark.h"
+#include"List.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>Twelve bytes don't divide a vector register, so this one takes the doubling memcpy path.</para>
+	/// </summary>
+	struct Triple
+	{
+		int x, y, z;
+	};
+
+	/// <summary>
+	/// <para>Construct measures allocation, page faults and the fill together. Append refills a buffer that is</para>
+	/// <para>already mapped, so only the stores are timed. 10^9 elements need --max-size=1000000000 and the memory for it.</para>
+	/// </summary>
+	template<typename Type>
+	void Run(Benchmark::Context& context, const char* element, const Type& value)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			if (size < 1000)
+				continue;
+
+			context.Measure("Construct", element, "List", size, [&]
+				{
+					List<Type> list(size, ListFill, value);
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+
+			{
+				List<Type> list(size, ListFill, value);
+				context.Measure("Append", element, "List", size, [&] { list.Empty(); }, [&]
+					{
+						list.Append(value, size);
+						Benchmark::DoNotOptimize(list.GetConstData());
+					});
+			}
+
+			context.Measure("Construct", element, "std::vector", size, [&]
+				{
+					std::vector<Type> vector(size, value);
+					Benchmark::DoNotOptimize(vector.data());
+				});
+
+			{
+				std::vector<Type> vector(size, value);
+				context.Measure("Append", element, "std::vector", size, [&] { vector.clear(); }, [&]
+					{
+						vector.insert(vector.end(), size, value);
+						Benchmark::DoNotOptimize(vector.data());
+					});
+			}
+		}
+	}
+
+	Benchmark::Registrar registrar("Fill", [](Benchmark::Context& context)
+		{
+			Run<char>(context, "char", 'x');
+			Run<int>(context, "int", 0x01020304);
+			Run<double>(context, "double", 2.5);
+			Run<Triple>(context, "Triple", Triple{ 1, 2, 3 });
+		});
+}
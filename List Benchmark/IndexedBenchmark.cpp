@@ -0,0 +1,98 @@
+// IndexedBenchmark.cpp : repeated IndexOf on large unsorted lists, the hash index of IndexedList against the scans of List.
+//
+
+#include<cstdint>
+#include<string>
+#include<type_traits>
+#include<vector>
+#include"Benchmark.h"
+#include"IndexedList.h"
+#include"List.h"
+
+namespace
+{
+	template<typename Type>
+	Type MakeValue(uint64_t seed)
+	{
+		if constexpr (std::is_same_v<Type, std::string>)
+			return "id-" + std::to_string(seed);
+		else
+			return (Type)seed;
+	}
+
+	/// <summary>
+	/// <para>[size] distinct values in a scrambled order, and 1024 queries, half of them present ones, half misses.</para>
+	/// </summary>
+	template<typename Type>
+	void MakeData(size_t size, std::vector<Type>& values, std::vector<Type>& queries)
+	{
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (size_t index = 0; index < size; ++index)
+			values.push_back(MakeValue<Type>((index * 0x5851F42D4C957F2Dull) % (size * 4) * 2));
+
+		for (size_t query = 0; query < 1024; ++query)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			queries.push_back(query & 1 ? MakeValue<Type>((state >> 17) * 2 + 1) : values[(state >> 17) % size]);
+		}
+	}
+
+	/// <summary>
+	/// <para>IndexOf runs [size] lookups, the List scans stop at 10^4 where they are quadratic in this loop.</para>
+	/// <para>Index is the first lookup after a change, which builds the index, AppendIndexed appends as many again,</para>
+	/// <para>which the index follows until it is half full and is dropped, to be built larger by the next lookup.</para>
+	/// </summary>
+	template<typename Type>
+	void Run(Benchmark::Context& context, const char* element)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			if (size < 1000)
+				continue;
+
+			std::vector<Type> values;
+			std::vector<Type> queries;
+			MakeData(size, values, queries);
+
+			if (size <= 10000)
+			{
+				List<Type> list(values.data(), size);
+				context.Measure("IndexOf", element, "List", size, [&]
+					{
+						size_t found = 0;
+						for (size_t index = 0; index < size; ++index)
+							found += list.IndexOf(queries[index % queries.size()]);
+						Benchmark::DoNotOptimize(found);
+					});
+			}
+
+			IndexedList<Type> indexed(values.data(), size);
+			indexed.Index();
+			context.Measure("IndexOf", element, "IndexedList", size, [&]
+				{
+					size_t found = 0;
+					for (size_t index = 0; index < size; ++index)
+						found += indexed.IndexOf(queries[index % queries.size()]);
+					Benchmark::DoNotOptimize(found);
+				});
+
+			context.Measure("Index", element, "IndexedList", size, [&] { indexed.GetData(); }, [&]
+				{
+					indexed.Index();
+					Benchmark::DoNotOptimize(indexed.IsIndexed());
+				});
+
+			context.Measure("AppendIndexed", element, "IndexedList", size, [&] { indexed = IndexedList<Type>(values.data(), size / 2); indexed.Index(); }, [&]
+				{
+					indexed.Append(values.data() + size / 2, size - size / 2);
+					Benchmark::DoNotOptimize(indexed.IsIndexed());
+				});
+		}
+	}
+
+	Benchmark::Registrar registrar("Indexed", [](Benchmark::Context& context)
+		{
+			Run<uint64_t>(context, "uint64_t");
+			Run<std::string>(context, "std::string");
+		});
+}
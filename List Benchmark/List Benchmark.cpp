@@ -0,0 +1,252 @@
+// List Benchmark.cpp : times List against std::vector and writes the results as CSV or JSON.
+//
+
+#include<vector>
+#include"Benchmark.h"
+#include"List.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>The same element declared trivially relocatable, so List grows it with realloc and memmove.</para>
+	/// </summary>
+	struct Relocatable :Benchmark::Generic
+	{
+		using Generic::Generic;
+	};
+}
+
+DefineRelocatableTypeTrait(Relocatable);
+
+namespace
+{
+	template<typename Type>
+	void RunList(Benchmark::Context& context, const char* element)
+	{
+		const char* container = "List";
+
+		for (size_t size : context.GetSizes())
+		{
+			List<Type> list;
+			context.Measure("Append", element, container, size,
+				[&] { list.~List<Type>(); new(&list)List<Type>(); },
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						list.Append(Type(index));
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+
+			context.Measure("IndexOf", element, container, size, [&] { Benchmark::DoNotOptimize(list.IndexOf(Type(size))); });
+
+			context.Measure("CopyWrite", element, container, size, [&]
+				{
+					List<Type> copy(list);
+					copy.Append(Type(0));
+					Benchmark::DoNotOptimize(copy.GetConstData());
+				});
+
+			context.Measure("Detach", element, container, size, [&]
+				{
+					List<Type> copy(list);
+					Benchmark::DoNotOptimize(copy.GetData());
+				});
+
+			context.Measure("Slice", element, container, size, [&]
+				{
+					List<Type> slice = list.GetRange(size / 4, size / 2);
+					Benchmark::DoNotOptimize(slice.GetConstData());
+				});
+
+			// One replacement, insert and delete every 64 elements, on a shared copy, applied in one pass.
+			List<Type> source(size, ListFill, Type(1));
+			context.Measure("Patch", element, container, size, [&]
+				{
+					List<Type> copy(source);
+					auto editor = copy.BeginEdit();
+					for (size_t index = 0; index + 32 < size; index += 64)
+						editor.Replace(index, Type(0)).Insert(index, Type(index)).Delete(index + 32, 1);
+					editor.Commit();
+					Benchmark::DoNotOptimize(copy.GetConstData());
+				});
+
+			// The front headroom makes these linear, std::vector runs them at the quadratic sizes.
+			context.Measure("Prepend", element, container, size,
+				[&] { list.~List<Type>(); new(&list)List<Type>(); },
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						list.Prepend(Type(index));
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+
+			context.Measure("DeleteFront", element, container, size,
+				[&]
+				{
+					list.~List<Type>();
+					new(&list)List<Type>();
+					for (size_t index = 0; index < size; ++index)
+						list.Append(Type(index));
+				},
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						list.Delete(0, 1);
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+		}
+
+		for (size_t size : context.GetSizes(true))
+		{
+			List<Type> list;
+			context.Measure("Insert", element, container, size,
+				[&] { list.~List<Type>(); new(&list)List<Type>(); },
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						list.Insert(list.GetSize() / 2, Type(index));
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+
+			context.Measure("Delete", element, container, size,
+				[&]
+				{
+					list.~List<Type>();
+					new(&list)List<Type>();
+					for (size_t index = 0; index < size; ++index)
+						list.Append(Type(index));
+				},
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						list.Delete(list.GetSize() / 2, 1);
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+		}
+	}
+
+	template<typename Type>
+	void RunVector(Benchmark::Context& context, const char* element)
+	{
+		const char* container = "std::vector";
+
+		for (size_t size : context.GetSizes())
+		{
+			std::vector<Type> vector;
+			context.Measure("Append", element, container, size,
+				[&] { vector = std::vector<Type>(); },
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						vector.push_back(Type(index));
+					Benchmark::DoNotOptimize(vector.data());
+				});
+
+			context.Measure("IndexOf", element, container, size, [&]
+				{
+					Benchmark::DoNotOptimize(std::find(vector.begin(), vector.end(), Type(size)));
+				});
+
+			context.Measure("CopyWrite", element, container, size, [&]
+				{
+					std::vector<Type> copy(vector);
+					copy.push_back(Type(0));
+					Benchmark::DoNotOptimize(copy.data());
+				});
+
+			context.Measure("Detach", element, container, size, [&]
+				{
+					std::vector<Type> copy(vector);
+					Benchmark::DoNotOptimize(copy.data());
+				});
+
+			context.Measure("Slice", element, container, size, [&]
+				{
+					std::vector<Type> slice(vector.begin() + size / 4, vector.begin() + size / 4 + size / 2);
+					Benchmark::DoNotOptimize(slice.data());
+				});
+		}
+
+		for (size_t size : context.GetSizes(true))
+		{
+			std::vector<Type> vector(size);
+			context.Measure("Patch", element, container, size, [&]
+				{
+					// Back to front, so the recorded indices stay valid.
+					std::vector<Type> copy(vector);
+					for (size_t index = size > 32 ? (size - 33) / 64 * 64 : 0; index + 32 < size; index -= 64)
+					{
+						copy.erase(copy.begin() + index + 32);
+						copy[index] = Type(0);
+						copy.insert(copy.begin() + index, Type(index));
+
+						if (!index)
+							break;
+					}
+					Benchmark::DoNotOptimize(copy.data());
+				});
+
+			vector = std::vector<Type>();
+			context.Measure("Prepend", element, container, size,
+				[&] { vector = std::vector<Type>(); },
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						vector.insert(vector.begin(), Type(index));
+					Benchmark::DoNotOptimize(vector.data());
+				});
+
+			context.Measure("Insert", element, container, size,
+				[&] { vector = std::vector<Type>(); },
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						vector.insert(vector.begin() + vector.size() / 2, Type(index));
+					Benchmark::DoNotOptimize(vector.data());
+				});
+
+			context.Measure("Delete", element, container, size,
+				[&]
+				{
+					vector = std::vector<Type>();
+					for (size_t index = 0; index < size; ++index)
+						vector.push_back(Type(index));
+				},
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						vector.erase(vector.begin() + vector.size() / 2);
+					Benchmark::DoNotOptimize(vector.data());
+				});
+
+			context.Measure("DeleteFront", element, container, size,
+				[&]
+				{
+					vector = std::vector<Type>();
+					for (size_t index = 0; index < size; ++index)
+						vector.push_back(Type(index));
+				},
+				[&]
+				{
+					for (size_t index = 0; index < size; ++index)
+						vector.erase(vector.begin());
+					Benchmark::DoNotOptimize(vector.data());
+				});
+		}
+	}
+
+	Benchmark::Registrar registrar("List", [](Benchmark::Context& context)
+		{
+			RunVector<int>(context, "Pod");
+			RunList<int>(context, "Pod");
+			RunVector<Benchmark::Generic>(context, "Generic");
+			RunList<Benchmark::Generic>(context, "Generic");
+			RunVector<Relocatable>(context, "Relocatable");
+			RunList<Relocatable>(context, "Relocatable");
+		});
+}
+
+int main(int argc, char** argv)
+{
+	return Benchmark::Run(argc, argv);
+}
@@ -0,0 +1,64 @@
+// MappedBenchmark.cpp : opening a file-backed MappedList against reading the same dataset into a List.
+//
+
+#include<cstdint>
+#include<cstdio>
+#include"Benchmark.h"
+#include"List.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include"MappedList.h"
+
+namespace
+{
+	const char* const Path = "ListBenchmark.mapped";
+
+	/// <summary>
+	/// <para>Open only maps the file and reads its header, the List has to read every element first.</para>
+	/// <para>The datasets stop at 10^7 elements, 80 MB of file, so the benchmark stays runnable anywhere.</para>
+	/// </summary>
+	void Run(Benchmark::Context& context)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			if (size < 1000 || size > 10000000)
+				continue;
+
+			context.Measure("Append", "uint64_t", "MappedList", size, [&]
+				{
+					MappedList<uint64_t> mapped(Path, MappedListMode::Create);
+					for (size_t index = 0; index < size; ++index)
+						mapped.Append((uint64_t)index);
+					Benchmark::DoNotOptimize(mapped.GetConstData());
+				});
+
+			// The dataset of this size, again in case Append is filtered out.
+			{
+				List<uint64_t> dataset(size, ListFill, 1);
+				MappedList<uint64_t>(Path, MappedListMode::Create).Append(dataset);
+			}
+
+			context.Measure("Open", "uint64_t", "MappedList", size, [&]
+				{
+					MappedList<uint64_t> mapped(Path, MappedListMode::ReadOnly);
+					Benchmark::DoNotOptimize(mapped.GetConstData()[mapped.GetSize() - 1]);
+				});
+
+			context.Measure("Open", "uint64_t", "List", size, [&]
+				{
+					std::FILE* file = std::fopen(Path, "rb");
+					std::fseek(file, sizeof(EscapistPrivate::MappedListHeader), SEEK_SET);
+
+					List<uint64_t> list(size);
+					size_t read = std::fread(list.GetData(), sizeof(uint64_t), size, file);
+					std::fclose(file);
+					Benchmark::DoNotOptimize(list.GetConstData()[read - 1]);
+				});
+		}
+
+		std::remove(Path);
+	}
+
+	Benchmark::Registrar registrar("Mapped", Run);
+}
+#endif
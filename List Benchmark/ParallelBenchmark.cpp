@@ -0,0 +1,94 @@
+// ParallelBenchmark.cpp : the parallel algorithms on pools of 1 to N threads.
+//
+
+#include<algorithm>
+#include<cstdint>
+#include<memory>
+#include<string>
+#include<thread>
+#include<vector>
+#include"Benchmark.h"
+#include"List.h"
+#include"ParallelAlgorithm.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>Pools of 1, 2, 4 ... threads up to the cores, the last one of all the cores, started once so no measure includes the thread creation.</para>
+	/// </summary>
+	std::vector<std::unique_ptr<ThreadPool>> CreatePools()
+	{
+		size_t cores = std::thread::hardware_concurrency();
+		if (!cores)
+			cores = 1;
+
+		std::vector<std::unique_ptr<ThreadPool>> pools;
+		for (size_t threadCount = 1; threadCount < cores; threadCount *= 2)
+			pools.emplace_back(new ThreadPool(threadCount));
+		pools.emplace_back(new ThreadPool(cores));
+		return pools;
+	}
+
+	/// <summary>
+	/// <para>Every size from 10^4 up, where the cutoff lets the pool work, to 10^8 elements, pass --max-size=100000000 for the largest.</para>
+	/// </summary>
+	void Run(Benchmark::Context& context)
+	{
+		std::vector<std::unique_ptr<ThreadPool>> pools = CreatePools();
+
+		for (size_t size : context.GetSizes())
+		{
+			if (size < 10000 || size > 100000000)
+				continue;
+
+			List<uint32_t> source(size);
+			uint32_t* values = source.GetData();
+			uint32_t state = 1;
+			for (size_t index = 0; index < size; ++index)
+				values[index] = state = state * 1664525 + 1013904223;
+
+			List<uint32_t> list(size);
+
+			for (const std::unique_ptr<ThreadPool>& pool : pools)
+			{
+				std::string threads = std::to_string(pool->GetThreadCount()) + (pool->GetThreadCount() == 1 ? " thread" : " threads");
+				auto refill = [&] { std::copy(source.GetConstData(), source.GetConstData() + size, list.GetData()); };
+
+				context.Measure("ForEach", "uint32_t", threads.c_str(), size, [&]
+					{
+						ParallelAlgorithm::ForEach(source, [](uint32_t value) { Benchmark::DoNotOptimize(value); }, *pool);
+					});
+
+				context.Measure("Transform", "uint32_t", threads.c_str(), size, [&]
+					{
+						List<uint64_t> result = ParallelAlgorithm::Transform(source, [](uint32_t value) { return (uint64_t)value * value; }, *pool);
+						Benchmark::DoNotOptimize(result.GetConstData());
+					});
+
+				context.Measure("Reduce", "uint32_t", threads.c_str(), size, [&]
+					{
+						Benchmark::DoNotOptimize(ParallelAlgorithm::Reduce(source, 0u, [](uint32_t left, uint32_t right) { return left ^ right; }, *pool));
+					});
+
+				context.Measure("Sort", "uint32_t", threads.c_str(), size, refill, [&]
+					{
+						ParallelAlgorithm::Sort(list, std::less<uint32_t>(), *pool);
+						Benchmark::DoNotOptimize(list.GetConstData());
+					});
+
+				context.Measure("StableSort", "uint32_t", threads.c_str(), size, refill, [&]
+					{
+						ParallelAlgorithm::StableSort(list, std::less<uint32_t>(), *pool);
+						Benchmark::DoNotOptimize(list.GetConstData());
+					});
+
+				context.Measure("Partition", "uint32_t", threads.c_str(), size, refill, [&]
+					{
+						Benchmark::DoNotOptimize(ParallelAlgorithm::Partition(list, [](uint32_t value) { return !(value & 1); }, *pool));
+					});
+			}
+		}
+	}
+
+	Benchmark::Registrar registrar("Parallel", Run);
+}
@@ -0,0 +1,58 @@
+// PoolBenchmark.cpp : short-lived lists through MallocPolicy against PoolPolicy.
+//
+
+#include"Benchmark.h"
+#include"List.h"
+#include"PoolAllocator.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>Creates and destroys [size] small lists, each one is filled and shared once,</para>
+	/// <para>so the data blocks of the list and of its detached copy go through the policy.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy>
+	void Run(Benchmark::Context& context, const char* element, const char* policy)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			context.Measure("CreateDestroy", element, policy, size, [&]
+				{
+					for (size_t index = 0; index < size; ++index)
+					{
+						List<Type, AllocPolicy> list;
+						list.Append(Type(index), 12);
+						Benchmark::DoNotOptimize(list.GetConstData());
+					}
+				});
+
+			context.Measure("ShareDestroy", element, policy, size, [&]
+				{
+					for (size_t index = 0; index < size; ++index)
+					{
+						List<Type, AllocPolicy> list;
+						list.Append(Type(index), 12);
+						List<Type, AllocPolicy> copy(list);
+						copy.Append(Type(index));
+						Benchmark::DoNotOptimize(copy.GetConstData());
+					}
+				});
+
+			context.Measure("Grow", element, policy, size, [&]
+				{
+					List<Type, AllocPolicy> list;
+					for (size_t index = 0; index < size; ++index)
+						list.Append(Type(index));
+					Benchmark::DoNotOptimize(list.GetConstData());
+				});
+		}
+	}
+
+	Benchmark::Registrar registrar("Pool", [](Benchmark::Context& context)
+		{
+			Run<int, MallocPolicy>(context, "int", "MallocPolicy");
+			Run<int, PoolPolicy>(context, "int", "PoolPolicy");
+			Run<char, MallocPolicy>(context, "char", "MallocPolicy");
+			Run<char, PoolPolicy>(context, "char", "PoolPolicy");
+		});
+}
@@ -0,0 +1,60 @@
+// ReferenceBenchmark.cpp : copying and destroying shared lists under the atomic and the local reference policy.
+//
+
+#include"Benchmark.h"
+#include"List.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>The block is shared beforehand, so every copy only increments the count and every destruction only decrements it.</para>
+	/// </summary>
+	template<typename ReferencePolicy>
+	void Run(Benchmark::Context& context, const char* policy)
+	{
+		using ListType = List<int, MallocPolicy, 0, HalfGrowthPolicy, ReferencePolicy>;
+
+		ListType source(64, 1);
+		ListType shared(source);
+
+		for (size_t size : context.GetSizes())
+		{
+			context.Measure("CopyDestroy", "int", policy, size, [&]
+				{
+					for (size_t index = 0; index < size; ++index)
+					{
+						ListType copy(source);
+						Benchmark::DoNotOptimize(copy.GetConstData());
+					}
+				});
+
+			// A new block shared for the first time, which only records its range in the block header.
+			context.Measure("FirstShare", "int", policy, size, [&]
+				{
+					for (size_t index = 0; index < size; ++index)
+					{
+						ListType list(source.GetConstData(), 12);
+						ListType copy(list);
+						Benchmark::DoNotOptimize(copy.GetConstData());
+					}
+				});
+
+			// Sixteen owners alive at once, as a request fanning one list out to its handlers.
+			context.Measure("FanOut", "int", policy, size, [&]
+				{
+					for (size_t index = 0; index < size; index += 16)
+					{
+						ListType copies[16] = { source, source, source, source, source, source, source, source,
+							source, source, source, source, source, source, source, source };
+						Benchmark::DoNotOptimize(copies[index % 16].GetConstData());
+					}
+				});
+		}
+	}
+
+	Benchmark::Registrar registrar("Reference", [](Benchmark::Context& context)
+		{
+			Run<AtomicReferencePolicy>(context, "AtomicReferencePolicy");
+			Run<LocalReferencePolicy>(context, "LocalReferencePolicy");
+		});
+}
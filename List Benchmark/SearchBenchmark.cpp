@@ -0,0 +1,61 @@
+// SearchBenchmark.cpp : IndexOf, LastIndexOf, Count and IndexOfAny over Pod lists against the std algorithms.
+//
+
+#include<algorithm>
+#include<vector>
+#include"Benchmark.h"
+#include"List.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>The list holds 0..size-1 modulo 100, every search is for a value that is absent or rare,</para>
+	/// <para>so each call scans the whole buffer.</para>
+	/// </summary>
+	template<typename Type>
+	void Run(Benchmark::Context& context, const char* element)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			std::vector<Type> vector(size);
+			for (size_t index = 0; index < size; ++index)
+				vector[index] = Type(index % 100);
+			List<Type> list(vector.data(), size);
+
+			const Type absent = Type(101);
+			const Type anyValues[] = { Type(101), Type(102), Type(103) };
+
+			context.Measure("IndexOf", element, "List", size, [&] { Benchmark::DoNotOptimize(list.IndexOf(absent)); });
+			context.Measure("LastIndexOf", element, "List", size, [&] { Benchmark::DoNotOptimize(list.LastIndexOf(absent)); });
+			context.Measure("Count", element, "List", size, [&] { Benchmark::DoNotOptimize(list.Count(Type(7))); });
+			context.Measure("IndexOfAny", element, "List", size, [&] { Benchmark::DoNotOptimize(list.IndexOfAny(anyValues, 3)); });
+
+			context.Measure("IndexOf", element, "std::vector", size, [&]
+				{
+					Benchmark::DoNotOptimize(std::find(vector.begin(), vector.end(), absent));
+				});
+			context.Measure("LastIndexOf", element, "std::vector", size, [&]
+				{
+					Benchmark::DoNotOptimize(std::find(vector.rbegin(), vector.rend(), absent));
+				});
+			context.Measure("Count", element, "std::vector", size, [&]
+				{
+					Benchmark::DoNotOptimize(std::count(vector.begin(), vector.end(), Type(7)));
+				});
+			context.Measure("IndexOfAny", element, "std::vector", size, [&]
+				{
+					Benchmark::DoNotOptimize(std::find_first_of(vector.begin(), vector.end(), anyValues, anyValues + 3));
+				});
+		}
+	}
+
+	Benchmark::Registrar registrar("Search", [](Benchmark::Context& context)
+		{
+			Run<char>(context, "char");
+			Run<short>(context, "short");
+			Run<int>(context, "int");
+			Run<long long>(context, "long long");
+			Run<float>(context, "float");
+			Run<double>(context, "double");
+		});
+}
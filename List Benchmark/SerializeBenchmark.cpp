@@ -0,0 +1,99 @@
+// SerializeBenchmark.cpp : ListSerializer snapshots against writing and reading the elements one by one.
+//
+
+#include<cstdint>
+#include<cstdio>
+#include<cstdlib>
+#include"Benchmark.h"
+#include"List.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include<fcntl.h>
+#include"ListSerializer.h"
+
+namespace
+{
+	const char* const Path = "ListBenchmark.serialized";
+
+	/// <summary>
+	/// <para>The files stay in the page cache, so these measure the copies and the checksum rather than the disk.</para>
+	/// </summary>
+	void Run(Benchmark::Context& context)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			if (size < 1000 || size > 10000000)
+				continue;
+
+			List<uint64_t> list(size, ListFill, 1);
+
+			context.Measure("Save", "uint64_t", "ListSerializer", size, [&]
+				{
+					int file = ::open(Path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+					Benchmark::DoNotOptimize(ListSerializer::Save(file, list));
+					::close(file);
+				});
+
+			context.Measure("Save", "uint64_t", "fwrite", size, [&]
+				{
+					std::FILE* file = std::fopen(Path, "wb");
+					const uint64_t* elements = list.GetConstData();
+					for (size_t index = 0; index < size; ++index)
+						std::fwrite(elements + index, sizeof(uint64_t), 1, file);
+					std::fclose(file);
+				});
+
+			// The snapshot of this size, again in case Save is filtered out.
+			{
+				int file = ::open(Path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+				ListSerializer::Save(file, list);
+				::close(file);
+			}
+
+			context.Measure("Load", "uint64_t", "ListSerializer", size, [&]
+				{
+					List<uint64_t> loaded;
+					int file = ::open(Path, O_RDONLY);
+					ListSerializer::Load(file, loaded);
+					::close(file);
+					Benchmark::DoNotOptimize(loaded.GetConstData());
+				});
+
+			context.Measure("Load", "uint64_t", "fread", size, [&]
+				{
+					List<uint64_t> loaded;
+					std::FILE* file = std::fopen(Path, "rb");
+					std::fseek(file, sizeof(EscapistPrivate::SerializedListHeader), SEEK_SET);
+
+					uint64_t element;
+					while (std::fread(&element, sizeof(uint64_t), 1, file) == 1)
+						loaded.Append(element);
+					std::fclose(file);
+					Benchmark::DoNotOptimize(loaded.GetConstData());
+				});
+
+			// The buffer is filled outside the measurement, Adopt only checks it and takes it over.
+			size_t bytes = ListSerializer::GetSerializedSize(list);
+			void* buffer = nullptr;
+			context.Measure("Adopt", "uint64_t", "ListSerializer", size,
+				[&]
+				{
+					buffer = MallocPolicy().Allocate(bytes);
+					std::FILE* file = std::fopen(Path, "rb");
+					Benchmark::DoNotOptimize(std::fread(buffer, 1, bytes, file));
+					std::fclose(file);
+				},
+				[&]
+				{
+					List<uint64_t> adopted;
+					ListSerializer::Adopt(buffer, bytes, adopted, false);
+					Benchmark::DoNotOptimize(adopted.GetConstData());
+				});
+		}
+
+		std::remove(Path);
+	}
+
+	Benchmark::Registrar registrar("Serialize", Run);
+}
+#endif
@@ -0,0 +1,96 @@
+// SortBenchmark.cpp : List::Sort and MergeSorted against std::sort and std::merge on std::vector.
+//
+
+#include<algorithm>
+#include<cstdint>
+#include<string>
+#include<type_traits>
+#include<vector>
+#include"Benchmark.h"
+#include"List.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>Uniform keys over the whole type, the worst case for the radix sort, which skips no pass. Strings take the introsort.</para>
+	/// </summary>
+	template<typename Type>
+	std::vector<Type> MakeValues(size_t size)
+	{
+		std::vector<Type> values(size);
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (Type& value : values)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			if constexpr (std::is_same_v<Type, std::string>)
+				value = std::to_string(state >> 16);
+			else if constexpr (std::is_floating_point_v<Type>)
+				value = (Type)((int64_t)state >> 11) / (Type)(1ll << 40);
+			else
+				value = (Type)(state >> 32 | state << 32);
+		}
+		return values;
+	}
+
+	/// <summary>
+	/// <para>Every repetition sorts the same unsorted values again, the refill in the setup is not timed.</para>
+	/// </summary>
+	template<typename Type>
+	void Run(Benchmark::Context& context, const char* element)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			std::vector<Type> values = MakeValues<Type>(size);
+
+			{
+				List<Type> list(values.data(), size);
+				context.Measure("Sort", element, "List", size, [&] { std::copy(values.begin(), values.end(), list.GetData()); }, [&]
+					{
+						list.Sort();
+						Benchmark::DoNotOptimize(list.GetConstData());
+					});
+			}
+
+			{
+				std::vector<Type> vector(values);
+				context.Measure("Sort", element, "std::vector", size, [&] { std::copy(values.begin(), values.end(), vector.begin()); }, [&]
+					{
+						std::sort(vector.begin(), vector.end());
+						Benchmark::DoNotOptimize(vector.data());
+					});
+			}
+
+			// Two sorted halves into one list of [size] elements.
+			std::vector<Type> left(values.begin(), values.begin() + size / 2);
+			std::vector<Type> right(values.begin() + size / 2, values.end());
+			std::sort(left.begin(), left.end());
+			std::sort(right.begin(), right.end());
+
+			{
+				List<Type> leftList(left.data(), left.size());
+				List<Type> rightList(right.data(), right.size());
+				context.Measure("MergeSorted", element, "List", size, [&]
+					{
+						List<Type> merged(leftList);
+						merged.MergeSorted(rightList);
+						Benchmark::DoNotOptimize(merged.GetConstData());
+					});
+			}
+
+			context.Measure("MergeSorted", element, "std::vector", size, [&]
+				{
+					std::vector<Type> merged(size);
+					std::merge(left.begin(), left.end(), right.begin(), right.end(), merged.begin());
+					Benchmark::DoNotOptimize(merged.data());
+				});
+		}
+	}
+
+	Benchmark::Registrar registrar("Sort", [](Benchmark::Context& context)
+		{
+			Run<uint32_t>(context, "uint32_t");
+			Run<uint64_t>(context, "uint64_t");
+			Run<float>(context, "float");
+			Run<std::string>(context, "std::string");
+		});
+}
@@ -0,0 +1,101 @@
+// SortedBenchmark.cpp : membership tests and batch inserts on sorted IDs, SortedList against List scans and std::vector.
+//
+
+#include<algorithm>
+#include<cstdint>
+#include<vector>
+#include"Benchmark.h"
+#include"List.h"
+#include"SortedList.h"
+
+namespace
+{
+	/// <summary>
+	/// <para>[size] distinct even IDs, queried by a stream of IDs half of which are odd, so every other query misses.</para>
+	/// </summary>
+	std::vector<uint64_t> MakeIds(size_t size)
+	{
+		std::vector<uint64_t> ids(size);
+		for (size_t index = 0; index < size; ++index)
+			ids[index] = index * 2;
+		return ids;
+	}
+
+	std::vector<uint64_t> MakeQueries(size_t size)
+	{
+		std::vector<uint64_t> queries(4096);
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (uint64_t& query : queries)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			query = (state >> 17) % (size * 2);
+		}
+		return queries;
+	}
+
+	template<typename Contains>
+	void MeasureContains(Benchmark::Context& context, const char* container, size_t size, const std::vector<uint64_t>& queries, const Contains& contains)
+	{
+		context.Measure("Contains", "uint64_t", container, size, [&]
+			{
+				size_t found = 0;
+				for (size_t index = 0; index < size; ++index)
+					found += contains(queries[index % queries.size()]);
+				Benchmark::DoNotOptimize(found);
+			});
+	}
+
+	/// <summary>
+	/// <para>Contains runs [size] queries. The linear scans of List::IsExist stop at 10^4, they are quadratic in this loop.</para>
+	/// <para>InsertSorted adds a batch of 1% of the size, 4096 at most, in any order, against the same elements inserted one by one.</para>
+	/// </summary>
+	void Run(Benchmark::Context& context)
+	{
+		for (size_t size : context.GetSizes())
+		{
+			std::vector<uint64_t> ids = MakeIds(size);
+			std::vector<uint64_t> queries = MakeQueries(size);
+
+			if (size <= 10000)
+			{
+				List<uint64_t> list(ids.data(), size);
+				MeasureContains(context, "List::IsExist", size, queries, [&](uint64_t id) { return list.IsExist(id); });
+			}
+
+			MeasureContains(context, "std::binary_search", size, queries, [&](uint64_t id) { return std::binary_search(ids.begin(), ids.end(), id); });
+
+			{
+				SortedList<uint64_t> sorted(ids.data(), size);
+				MeasureContains(context, "SortedList", size, queries, [&](uint64_t id) { return sorted.Contains(id); });
+			}
+
+			{
+				SortedList<uint64_t, std::less<uint64_t>, SortedListLayout::Eytzinger> eytzinger(ids.data(), size);
+				MeasureContains(context, "SortedList Eytzinger", size, queries, [&](uint64_t id) { return eytzinger.Contains(id); });
+			}
+
+			size_t batchSize = size / 100 ? size / 100 : 1;
+			std::vector<uint64_t> batch(queries.begin(), queries.begin() + (batchSize < queries.size() ? batchSize : queries.size()));
+			for (uint64_t& id : batch)
+				id |= 1;
+
+			{
+				SortedList<uint64_t> sorted;
+				context.Measure("InsertSorted", "uint64_t", "SortedList batch", size, [&] { sorted = SortedList<uint64_t>(ids.data(), size); }, [&]
+					{
+						sorted.InsertSorted(batch.data(), batch.size());
+						Benchmark::DoNotOptimize(sorted.GetConstData());
+					});
+
+				context.Measure("InsertSorted", "uint64_t", "SortedList one by one", size, [&] { sorted = SortedList<uint64_t>(ids.data(), size); }, [&]
+					{
+						for (uint64_t id : batch)
+							sorted.Insert(id);
+						Benchmark::DoNotOptimize(sorted.GetConstData());
+					});
+			}
+		}
+	}
+
+	Benchmark::Registrar registrar("Sorted", Run);
+}
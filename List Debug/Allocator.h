@@ -1,17 +1,36 @@
 #pragma once
 
 #include<cassert>
+#include<cstddef>
+#include<cstdint>
+#include<cstdlib>
+#include<cstring>
 #include<memory>
+#include<type_traits>
+#include<utility>
+#if defined(__linux__)
+#include<sys/mman.h>
+#endif
+#include"ListStatistics.h"
 #include"TypeTrait.h"
 
 template<typename Type>
 class Allocator
 {
+private:
+	static void CountReallocation(const Type* input, const Type* pointer)
+	{
+		ListStatistics<Type>::Add(ListCounter::Reallocations);
+		if (input && pointer != input)
+			ListStatistics<Type>::Add(ListCounter::MovedReallocations);
+	}
+
 public:
 	static Type* Allocate()
 	{
 		Type* pointer = (Type*)::malloc(sizeof(Type));
 		assert(pointer);
+		ListStatistics<Type>::Add(ListCounter::Allocations);
 		return pointer;
 	}
 
@@ -19,44 +38,53 @@ public:
 	{
 		pointer = (Type*)::malloc(sizeof(Type));
 		assert(pointer);
+		ListStatistics<Type>::Add(ListCounter::Allocations);
 	}
 
 	static void Allocate(Type*& pointer, size_t capacity)
 	{
 		pointer = (Type*)::malloc(capacity);
 		assert(pointer);
+		ListStatistics<Type>::Add(ListCounter::Allocations);
 	}
 
 	static Type* Allocate(size_t capacity)
 	{
 		Type* pointer = (Type*)::malloc(capacity);
 		assert(pointer);
+		ListStatistics<Type>::Add(ListCounter::Allocations);
 		return pointer;
 	}
 
 	static void Reallocate(Type*& pointer, size_t capacity)
 	{
-		pointer = (Type*)::realloc((void*)pointer, capacity);
+		Type* input = pointer;
+		pointer = (Type*)::realloc((void*)input, capacity);
 		assert(pointer);
+		CountReallocation(input, pointer);
 	}
 
 	static Type* ReallocateNew(Type* input, size_t capacity)
 	{
 		Type* pointer = (Type*)::realloc((void*)input, capacity);
 		assert(pointer);
+		CountReallocation(input, pointer);
 		return pointer;
 	}
 
 	static void TypedReallocate(Type*& pointer, size_t capacity)
 	{
-		pointer = (Type*)::realloc((void*)pointer, capacity * sizeof(Type));
+		Type* input = pointer;
+		pointer = (Type*)::realloc((void*)input, capacity * sizeof(Type));
 		assert(pointer);
+		CountReallocation(input, pointer);
 	}
 
 	static Type* TypedReallocateNew(Type* input, size_t capacity)
 	{
 		Type* pointer = (Type*)::realloc((void*)input, capacity * sizeof(Type));
 		assert(pointer);
+		CountReallocation(input, pointer);
 		return pointer;
 	}
 
@@ -64,12 +92,14 @@ public:
 	{
 		pointer = (Type*)::malloc(capacity * sizeof(Type));
 		assert(pointer);
+		ListStatistics<Type>::Add(ListCounter::Allocations);
 	}
 
 	static Type* TypedAllocate(size_t capacity)
 	{
 		Type* pointer = (Type*)::malloc(capacity * sizeof(Type));
 		assert(pointer);
+		ListStatistics<Type>::Add(ListCounter::Allocations);
 		return pointer;
 	}
 
@@ -98,4 +128,353 @@ public:
 	{
 		::free((void*)pointer);
 	}
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// <para>The allocation policy of the list buffers, the default one forwards to ::malloc, ::realloc and ::free.</para>
+/// <para>A policy provides Allocate(size), Reallocate(pointer, oldSize, newSize) and Free(pointer, size).</para>
+/// <para>The sizes are always the ones of the original request, so the policy never needs to record them.</para>
+/// <para>GetUsableSize(size) is optional, only SizeClassGrowthPolicy asks for it.</para>
+/// <para>Alignment is optional too, a policy declaring it returns blocks aligned to it, and the list aligns its elements to it.</para>
+/// <para>Policies are stored as an empty base, only a stateful one makes the list larger, by its own state.</para>
+/// </summary>
+class MallocPolicy
+{
+public:
+	void* Allocate(size_t size)
+	{
+		void* pointer = ::malloc(size);
+		assert(pointer);
+		return pointer;
+	}
+
+	void* Reallocate(void* pointer, size_t, size_t newSize)
+	{
+		pointer = ::realloc(pointer, newSize);
+		assert(pointer);
+		return pointer;
+	}
+
+	void Free(void* pointer, size_t) { ::free(pointer); }
+
+	/// <summary>
+	/// <para>The bytes a request of [size] really gets, rounded up to the size class of the C library.</para>
+	/// <para>glibc serves 16-byte steps after a one-word header, and whole pages above its mmap threshold, others are taken as 16-byte steps.</para>
+	/// </summary>
+	size_t GetUsableSize(size_t size)const
+	{
+#if defined(__GLIBC__)
+		constexpr size_t Word = sizeof(size_t);
+		constexpr size_t Page = 4096;
+
+		if (size >= 128 * 1024) // The default mmap threshold, a mapped chunk has a two-word header.
+			return ((size + 2 * Word + Page - 1) & ~(Page - 1)) - 2 * Word;
+
+		size_t chunk = (size + Word + 15) & ~(size_t)15;
+		return (chunk < 4 * Word ? 4 * Word : chunk) - Word;
+#else
+		return (size + 15) & ~(size_t)15;
+#endif
+	}
+};
+
+/// <summary>
+/// <para>A monotonic arena over a caller-owned buffer, typically one per request.</para>
+/// <para>Freed memory is only reclaimed when it is the latest allocation, or by Reset() for the whole arena.</para>
+/// <para>When the buffer is exhausted, it falls back to ::malloc, those blocks are released by Free as usual.</para>
+/// </summary>
+class Arena
+{
+private:
+	static constexpr size_t Alignment = alignof(std::max_align_t);
+
+	char* buffer;
+	size_t capacity;
+	size_t used;
+
+	static size_t Align(size_t size) { return (size + Alignment - 1) & ~(Alignment - 1); }
+
+public:
+	Arena(void* buffer, size_t capacity)
+		:buffer((char*)buffer), capacity(capacity), used(0)
+	{}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	bool IsOwning(const void* pointer)const { return (const char*)pointer >= buffer && (const char*)pointer < buffer + capacity; }
+	bool IsLatest(const void* pointer, size_t size)const { return (const char*)pointer + Align(size) == buffer + used; }
+
+	size_t GetUsed()const { return used; }
+	size_t GetCapacity()const { return capacity; }
+	size_t GetUsableSize(size_t size)const { return Align(size); }
+
+	void* Allocate(size_t size)
+	{
+		size = Align(size);
+		if (size > capacity - used)
+			return MallocPolicy().Allocate(size);
+
+		void* pointer = buffer + used;
+		used += size;
+		return pointer;
+	}
+
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize)
+	{
+		if (!IsOwning(pointer))
+			return MallocPolicy().Reallocate(pointer, oldSize, newSize);
+
+		if (IsLatest(pointer, oldSize) && Align(newSize) <= capacity - ((char*)pointer - buffer))
+		{
+			used = ((char*)pointer - buffer) + Align(newSize);
+			return pointer;
+		}
+
+		void* newPointer = Allocate(newSize);
+		::memcpy(newPointer, pointer, oldSize < newSize ? oldSize : newSize);
+		Free(pointer, oldSize);
+		return newPointer;
+	}
+
+	void Free(void* pointer, size_t size)
+	{
+		if (!IsOwning(pointer))
+			MallocPolicy().Free(pointer, size);
+		else if (IsLatest(pointer, size))
+			used = (char*)pointer - buffer;
+	}
+
+	void Reset() { used = 0; }
+};
+
+/// <summary>
+/// <para>A stateful policy routing the list buffers to an Arena, the list carries only the arena pointer.</para>
+/// </summary>
+class ArenaPolicy
+{
+private:
+	Arena* arena;
+
+public:
+	ArenaPolicy(Arena& arena) :arena(&arena) {}
+
+	Arena& GetArena()const { return *arena; }
+
+	bool operator==(const ArenaPolicy& other)const { return arena == other.arena; }
+	bool operator!=(const ArenaPolicy& other)const { return arena != other.arena; }
+
+	void* Allocate(size_t size) { return arena->Allocate(size); }
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize) { return arena->Reallocate(pointer, oldSize, newSize); }
+	void Free(void* pointer, size_t size) { arena->Free(pointer, size); }
+
+	size_t GetUsableSize(size_t size)const { return arena->GetUsableSize(size); }
+};
+
+/// <summary>
+/// <para>A policy whose blocks start on [AlignmentValue] bytes, a cache line by default, the list then starts its elements on one too.</para>
+/// <para>Reallocate keeps realloc, growing in place or remapping a large block is cheaper than any copy,</para>
+/// <para>and only a block it moved off the boundary is copied again to an aligned one.</para>
+/// <para>Blocks of [HugePageThreshold] bytes and more, if not 0, are aligned to 2 MiB and advised as transparent huge pages on Linux,</para>
+/// <para>a scan over them then misses the TLB once per 2 MiB rather than once per 4 KiB page.</para>
+/// </summary>
+template<size_t AlignmentValue = 64, size_t HugePageThreshold = 0>
+class AlignedPolicy
+{
+private:
+	static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+	static constexpr size_t HugePageAlignment = HugePageSize > AlignmentValue ? HugePageSize : AlignmentValue;
+
+	static_assert(AlignmentValue >= sizeof(void*) && !(AlignmentValue & (AlignmentValue - 1)), "The alignment must be a power of two, at least a pointer.");
+
+#if defined(__linux__)
+	static bool IsHuge(size_t size) { return HugePageThreshold && size >= HugePageThreshold; }
+#else
+	static bool IsHuge(size_t) { return false; } // No transparent huge pages to ask for.
+#endif
+
+	/// <summary>
+	/// <para>aligned_alloc takes whole multiples of the alignment only, so every block is rounded up, and the rest is usable.</para>
+	/// <para>The size is huge or not once rounded to the alignment, a huge one is rounded on to the huge page alignment and stays huge.</para>
+	/// </summary>
+	static size_t GetBlockSize(size_t size)
+	{
+		size = (size + Alignment - 1) & ~(Alignment - 1);
+		return IsHuge(size) ? (size + HugePageAlignment - 1) & ~(HugePageAlignment - 1) : size;
+	}
+
+	static void* AllocateAligned(size_t alignment, size_t size)
+	{
+#if defined(_MSC_VER)
+		void* pointer = ::_aligned_malloc(size, alignment);
+#else
+		void* pointer = ::aligned_alloc(alignment, size);
+#endif
+		assert(pointer);
+		return pointer;
+	}
+
+	/// <summary>
+	/// <para>Only the whole pages inside the block are advised, a block remapped by realloc is advised again, the advice is a hint anyway.</para>
+	/// </summary>
+	static void AdviseHugePages(void* pointer, size_t size)
+	{
+#if defined(MADV_HUGEPAGE)
+		constexpr uintptr_t Page = 4096;
+		uintptr_t begin = ((uintptr_t)pointer + Page - 1) & ~(Page - 1);
+		uintptr_t end = ((uintptr_t)pointer + size) & ~(Page - 1);
+		if (begin < end)
+			::madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#else
+		(void)pointer;
+		(void)size;
+#endif
+	}
+
+public:
+	static constexpr size_t Alignment = AlignmentValue;
+
+	void* Allocate(size_t size)
+	{
+		size = GetBlockSize(size);
+		if (!IsHuge(size))
+			return AllocateAligned(Alignment, size);
+
+		void* pointer = AllocateAligned(HugePageAlignment, size);
+		AdviseHugePages(pointer, size);
+		return pointer;
+	}
+
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize)
+	{
+		oldSize = GetBlockSize(oldSize);
+		newSize = GetBlockSize(newSize);
+		if (oldSize == newSize)
+			return pointer;
+
+#if defined(_MSC_VER)
+		void* newPointer = ::_aligned_realloc(pointer, newSize, Alignment);
+		assert(newPointer);
+#else
+		if (IsHuge(newSize) && !IsHuge(oldSize)) // Crossing the threshold, the block moves to a 2 MiB boundary.
+		{
+			void* newPointer = Allocate(newSize);
+			::memcpy(newPointer, pointer, oldSize);
+			Free(pointer, oldSize);
+			return newPointer;
+		}
+
+		void* newPointer = ::realloc(pointer, newSize);
+		assert(newPointer);
+
+		if ((uintptr_t)newPointer & (Alignment - 1))
+		{
+			void* aligned = AllocateAligned(Alignment, newSize);
+			::memcpy(aligned, newPointer, oldSize < newSize ? oldSize : newSize);
+			::free(newPointer);
+			newPointer = aligned;
+		}
+#endif
+
+		if (IsHuge(newSize) && newPointer != pointer)
+			AdviseHugePages(newPointer, newSize);
+		return newPointer;
+	}
+
+	void Free(void* pointer, size_t)
+	{
+#if defined(_MSC_VER)
+		::_aligned_free(pointer);
+#else
+		::free(pointer);
+#endif
+	}
+
+	size_t GetUsableSize(size_t size)const { return GetBlockSize(size); }
+};
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The alignment an allocation policy declares, of the blocks it returns and of the elements in them.</para>
+	/// <para>A policy declaring none returns what ::malloc does, and asks nothing of the element layout.</para>
+	/// </summary>
+	template<typename AllocPolicy, typename = void>
+	struct AllocPolicyAlignment
+	{
+		static constexpr size_t Block = alignof(std::max_align_t);
+		static constexpr size_t Data = 1;
+	};
+
+	template<typename AllocPolicy>
+	struct AllocPolicyAlignment<AllocPolicy, std::void_t<decltype(AllocPolicy::Alignment)>>
+	{
+		static constexpr size_t Block = AllocPolicy::Alignment;
+		static constexpr size_t Data = AllocPolicy::Alignment;
+	};
+
+	/// <summary>
+	/// <para>Whether a block of one policy may be freed by the other. Any stateless policy frees the blocks of another of its type,</para>
+	/// <para>a stateful one compares with operator==, as ArenaPolicy does, and without it never stands in for another.</para>
+	/// </summary>
+	template<typename AllocPolicy, typename = void>
+	struct AllocPolicyEquality
+	{
+		static bool IsEqual(const AllocPolicy&, const AllocPolicy&) { return std::is_empty_v<AllocPolicy>; }
+	};
+
+	template<typename AllocPolicy>
+	struct AllocPolicyEquality<AllocPolicy, std::void_t<decltype(std::declval<const AllocPolicy&>() == std::declval<const AllocPolicy&>())>>
+	{
+		static bool IsEqual(const AllocPolicy& left, const AllocPolicy& right) { return left == right; }
+	};
+
+	/// <summary>
+	/// <para>The blocks of [AllocPolicy] aligned to [Alignment], beyond what it returns, for elements aligned that much.</para>
+	/// <para>Every block is requested [Alignment] bytes larger and handed out from its first boundary past a word,</para>
+	/// <para>the word before that boundary keeps how far it is from the start of the block of the policy.</para>
+	/// <para>It only refers to the policy of the list, so a stateful one, an arena say, still serves the blocks.</para>
+	/// </summary>
+	template<typename AllocPolicy, size_t Alignment>
+	class OverAlignedPolicy
+	{
+	private:
+		static_assert(AllocPolicyAlignment<std::remove_const_t<AllocPolicy>>::Block >= sizeof(size_t), "The word before the boundary must fit in the padding.");
+
+		AllocPolicy& policy;
+
+		static unsigned char* Align(void* block) { return (unsigned char*)(((uintptr_t)block + Alignment) & ~(uintptr_t)(Alignment - 1)); }
+		static size_t& GetOffset(void* pointer) { return ((size_t*)pointer)[-1]; }
+
+	public:
+		explicit OverAlignedPolicy(AllocPolicy& policy) :policy(policy) {}
+
+		void* Allocate(size_t size)
+		{
+			void* block = policy.Allocate(size + Alignment);
+			unsigned char* pointer = Align(block);
+			GetOffset(pointer) = (size_t)(pointer - (unsigned char*)block);
+			return pointer;
+		}
+
+		/// <summary>
+		/// <para>A block the policy moved may start at another distance from the boundary, the bytes are then moved to the new one.</para>
+		/// </summary>
+		void* Reallocate(void* pointer, size_t oldSize, size_t newSize)
+		{
+			size_t offset = GetOffset(pointer);
+			void* block = policy.Reallocate((unsigned char*)pointer - offset, oldSize + Alignment, newSize + Alignment);
+			unsigned char* newPointer = Align(block);
+			size_t newOffset = (size_t)(newPointer - (unsigned char*)block);
+
+			if (newOffset != offset)
+				::memmove(newPointer, (unsigned char*)block + offset, oldSize < newSize ? oldSize : newSize);
+			GetOffset(newPointer) = newOffset;
+			return newPointer;
+		}
+
+		void Free(void* pointer, size_t size) { policy.Free((unsigned char*)pointer - GetOffset(pointer), size + Alignment); }
+
+		size_t GetUsableSize(size_t size)const { return policy.GetUsableSize(size + Alignment) - Alignment; }
+	};
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include<atomic>
+#include<cassert>
+#include<cstddef>
+#include<cstdlib>
+#include<utility>
+#include"List.h"
+
+/// <summary>
+/// <para>A list many threads append to at once without a lock, read while they append, then sealed into a List.</para>
+/// <para>A producer reserves its slots with one fetch-add on the size and constructs its elements in place, no producer ever waits for another.</para>
+/// <para>The slots are one block of the allocation policy, reserved for [reservedCapacity] elements up front and never moved nor freed</para>
+/// <para>while the producers run, so a reader never sees freed memory. ::malloc maps a large block lazily, its pages are only</para>
+/// <para>committed as the producers reach them, so a generous reservation costs address space rather than memory.</para>
+/// <para>Seal hands the block itself to the List, and gives the untouched rest back through the Reallocate of the policy,</para>
+/// <para>which ::realloc shrinks in place. The elements are never copied, non-relocatable ones keep the rest as capacity.</para>
+/// <para>The producers append at once, the allocation policy is only called by the constructor and Seal.</para>
+/// </summary>
+template<typename Type, typename AllocPolicy = MallocPolicy>
+class ConcurrentAppendList :private AllocPolicy
+{
+private:
+	using Self = ConcurrentAppendList<Type, AllocPolicy>;
+	using ListType = List<Type, AllocPolicy>;
+	using Core = typename ListType::Core;
+
+	size_t capacity;
+	void* block;
+	std::atomic<unsigned char>* written; // One flag per slot, set with release once its element is constructed.
+
+	alignas(64) std::atomic<size_t> reserved;
+	std::atomic<size_t> limit; // The end of the appended slots, the reservation or the start of the one append that passed it.
+
+	AllocPolicy& GetAllocPolicy() { return *this; }
+
+	Type* GetElements()const { return (Type*)((unsigned char*)block + Core::CalculateBlockSize(0)); }
+
+	/// <summary>
+	/// <para>A new reservation for the next producers. The flags come zeroed from ::calloc, as lazily as the block.</para>
+	/// </summary>
+	void Allocate()
+	{
+		block = Core::GetBlockPolicy(GetAllocPolicy()).Allocate(Core::CalculateBlockSize(capacity));
+		written = (std::atomic<unsigned char>*)::calloc(capacity ? capacity : 1, sizeof(std::atomic<unsigned char>));
+		assert(written);
+
+		reserved.store(0, std::memory_order_relaxed);
+		limit.store(capacity, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// <para>Reserve [count] slots and fill them with [construct](slot, offset), or return false if they pass the reservation.</para>
+	/// <para>The slots are contiguous, so only one append can start before the end and pass it, it marks where the elements end.</para>
+	/// </summary>
+	template<typename Construct>
+	bool WriteSlots(size_t count, const Construct& construct)
+	{
+		size_t index = reserved.fetch_add(count, std::memory_order_relaxed);
+		if (index > capacity || count > capacity - index)
+		{
+			if (index < capacity)
+				limit.store(index, std::memory_order_relaxed);
+			return false;
+		}
+
+		Type* elements = GetElements() + index;
+		for (size_t offset = 0; offset < count; ++offset)
+			construct(elements + offset, offset);
+
+		// One fence orders every element before all of its flags.
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t offset = 0; offset < count; ++offset)
+			written[index + offset].store(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Destroy the elements and free the reservation, the producers and the readers are all done.</para>
+	/// </summary>
+	void Release(size_t count)
+	{
+		Core::TypeTrait::Destroy(GetElements(), count);
+		Core::GetBlockPolicy(GetAllocPolicy()).Free(block, Core::CalculateBlockSize(capacity));
+		::free((void*)written);
+	}
+
+public:
+	/// <summary>
+	/// <para>Reserve room for [reservedCapacity] elements, the most the producers may append before each Seal.</para>
+	/// </summary>
+	explicit ConcurrentAppendList(size_t reservedCapacity, const AllocPolicy& policy = AllocPolicy())
+		:AllocPolicy(policy), capacity(reservedCapacity), block(nullptr), written(nullptr), reserved(0), limit(0)
+	{
+		Allocate();
+	}
+
+	ConcurrentAppendList(const Self&) = delete;
+	Self& operator=(const Self&) = delete;
+
+	~ConcurrentAppendList()
+	{
+		Release(GetCount());
+	}
+
+	/// <summary>
+	/// <para>Returns false, appending nothing, if the reservation is full.</para>
+	/// </summary>
+	bool Append(const Type& value)
+	{
+		return WriteSlots(1, [&](Type* slot, size_t) { Allocator<Type>::CopyConstruct(slot, value); });
+	}
+
+	bool Append(Type&& value)
+	{
+		return WriteSlots(1, [&](Type* slot, size_t) { Allocator<Type>::ParameterConstruct(slot, std::move(value)); });
+	}
+
+	/// <summary>
+	/// <para>Append [count] elements as one contiguous run, reserved with a single fetch-add, or none of them if they do not fit.</para>
+	/// </summary>
+	bool Append(const Type* values, size_t count)
+	{
+		if (!values || !count)
+			return true;
+
+		return WriteSlots(count, [&](Type* slot, size_t offset) { Allocator<Type>::CopyConstruct(slot, values[offset]); });
+	}
+
+	/// <summary>
+	/// <para>The element at [index] if its producer is done writing it, otherwise nullptr.</para>
+	/// <para>It stays where it is until Seal, which must wait for the readers as for the producers.</para>
+	/// </summary>
+	const Type* GetWritten(size_t index)const
+	{
+		return index < capacity && written[index].load(std::memory_order_acquire) ? GetElements() + index : nullptr;
+	}
+
+	/// <summary>
+	/// <para>Call [function](index, element) for the written elements from [start] on, up to the first one not written yet,</para>
+	/// <para>and return its index, where a reader following the producers starts the next time.</para>
+	/// </summary>
+	template<typename Function>
+	size_t ForEachWritten(size_t start, Function function)const
+	{
+		const Type* elements = GetElements();
+		for (; start < capacity && written[start].load(std::memory_order_acquire); ++start)
+			function(start, elements[start]);
+		return start;
+	}
+
+	/// <summary>
+	/// <para>The elements appended or being appended so far.</para>
+	/// </summary>
+	size_t GetCount()const
+	{
+		size_t count = reserved.load(std::memory_order_relaxed);
+		size_t end = limit.load(std::memory_order_relaxed);
+		return count < end ? count : end;
+	}
+	size_t GetSize()const { return GetCount(); }
+	size_t GetCapacity()const { return capacity; }
+
+	/// <summary>
+	/// <para>Hand the elements over as a List whose block is the reservation, and start again empty with a new one.</para>
+	/// <para>Every producer and reader must be done: their calls happen before Seal, joined or otherwise synchronized.</para>
+	/// </summary>
+	ListType Seal()
+	{
+		size_t count = GetCount();
+		ListType list(GetAllocPolicy());
+
+		if (!count)
+		{
+			reserved.store(0, std::memory_order_relaxed);
+			limit.store(capacity, std::memory_order_relaxed);
+			return list;
+		}
+
+		list.core.AdoptBlock(block, capacity, 0, count);
+		if (Core::TypeTrait::IsRelocatable)
+			list.core.ShrinkToFit();
+
+		::free((void*)written);
+		Allocate();
+		return list;
+	}
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include<cstddef>
+
+/// <summary>
+/// <para>The growth policy of the list buffers, chosen at compile time, the default one grows by half.</para>
+/// <para>A policy provides CalculateCapacity(allocPolicy, size, elementSize, headerSize), the capacity in elements for [size] elements.</para>
+/// <para>It also provides ShrinkRatio, zero or how many times the size the capacity may reach before Delete gives memory back.</para>
+/// </summary>
+class HalfGrowthPolicy
+{
+public:
+	static constexpr size_t ShrinkRatio = 0;
+
+	template<typename AllocPolicy>
+	static size_t CalculateCapacity(const AllocPolicy&, size_t size, size_t, size_t) { return size + size / 2; }
+};
+
+/// <summary>
+/// <para>Doubles the capacity, fewer reallocations for lists growing without bound at the cost of more slack.</para>
+/// </summary>
+class DoubleGrowthPolicy
+{
+public:
+	static constexpr size_t ShrinkRatio = 0;
+
+	template<typename AllocPolicy>
+	static size_t CalculateCapacity(const AllocPolicy&, size_t size, size_t, size_t) { return size * 2; }
+};
+
+/// <summary>
+/// <para>Grows like [BaseGrowth], then rounds the block up to the size class the allocator really hands out.</para>
+/// <para>The bytes the allocator would waste at the end of the block become capacity instead.</para>
+/// <para>The allocation policy must provide GetUsableSize(size).</para>
+/// </summary>
+template<typename BaseGrowth = HalfGrowthPolicy>
+class SizeClassGrowthPolicy
+{
+public:
+	static constexpr size_t ShrinkRatio = BaseGrowth::ShrinkRatio;
+
+	template<typename AllocPolicy>
+	static size_t CalculateCapacity(const AllocPolicy& allocPolicy, size_t size, size_t elementSize, size_t headerSize)
+	{
+		size_t capacity = BaseGrowth::CalculateCapacity(allocPolicy, size, elementSize, headerSize);
+		return (allocPolicy.GetUsableSize(headerSize + capacity * elementSize) - headerSize) / elementSize;
+	}
+};
+
+/// <summary>
+/// <para>Grows like [BaseGrowth], and Delete shrinks the block once the capacity exceeds [Ratio] times the size.</para>
+/// <para>The new capacity is the one growing to the remaining size would pick, so shrinking and growing cannot alternate.</para>
+/// </summary>
+template<typename BaseGrowth = HalfGrowthPolicy, size_t Ratio = 4>
+class ShrinkingGrowthPolicy :public BaseGrowth
+{
+public:
+	static_assert(Ratio >= 3, "The ratio must leave room between the shrunk capacity and the next shrink.");
+
+	static constexpr size_t ShrinkRatio = Ratio;
+};
@@ -0,0 +1,317 @@
+#pragma once
+
+#include<atomic>
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<functional>
+#include<utility>
+#include"List.h"
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The start of a hash index block, the slots follow it. A slot holds the index of an element plus one, 0 is a free slot.</para>
+	/// <para>The copies of an IndexedList share the block like they share their elements, the one changing alone may update it in place.</para>
+	/// </summary>
+	struct HashIndexHeader
+	{
+		ReferenceCount<AtomicReferencePolicy> count;
+		size_t mask;
+		size_t used;
+
+		explicit HashIndexHeader(size_t mask) :count(1), mask(mask), used(0) {}
+	};
+}
+
+/// <summary>
+/// <para>A List with an opt-in lookup index: an open-addressing hash table, probed linearly, from each value to its first index.</para>
+/// <para>The index is built by the first IndexOf after a change, in O(n), and answers in O(1) until the next change.</para>
+/// <para>Appending updates it in place, every other change of the elements drops it, as does GetData, which lets the caller write them.</para>
+/// <para>The slots only hold indices, the values are compared in the list itself, so the index costs two words per element at most.</para>
+/// <para>Copies share the index with the block. The first lookup of several threads at once may build it twice, one of them is kept.</para>
+/// </summary>
+template<typename Type, typename Hash = std::hash<Type>, typename AllocPolicy = MallocPolicy>
+class IndexedList :private Hash // Empty base, so a stateless hash costs nothing.
+{
+private:
+	using Self = IndexedList<Type, Hash, AllocPolicy>;
+	using ListType = List<Type, AllocPolicy>;
+	using TypeTrait = typename TypeTraitPatternSelector<Type>::TypeTrait;
+	using Header = EscapistPrivate::HashIndexHeader;
+
+	/// <summary>
+	/// <para>Below this many elements, the scan, vectorized for Pod elements, wins over hashing.</para>
+	/// </summary>
+	static constexpr size_t MinimumSize = 64;
+	static constexpr size_t MinimumSlots = 16;
+
+	ListType list;
+	mutable std::atomic<Header*> index;
+
+	const Hash& GetHash()const { return *this; }
+
+	static size_t* GetSlots(Header* header) { return (size_t*)(header + 1); }
+	static size_t CalculateIndexSize(size_t slotCount) { return sizeof(Header) + slotCount * sizeof(size_t); }
+
+	/// <summary>
+	/// <para>The hash is mixed by a Fibonacci multiply, the identity std::hash of the integers would pile strided values on few slots.</para>
+	/// </summary>
+	size_t GetHome(const Type& value, size_t mask)const
+	{
+		uint64_t mixed = (uint64_t)GetHash()(value) * 0x9E3779B97F4A7C15ull;
+		return (size_t)(mixed ^ (mixed >> 32)) & mask;
+	}
+
+	/// <summary>
+	/// <para>The slot holding [value], or the free slot where it would go. The table is at most half full, so there is always one.</para>
+	/// </summary>
+	size_t* Probe(Header* header, const Type* elements, const Type& value)const
+	{
+		size_t* slots = GetSlots(header);
+		for (size_t slot = GetHome(value, header->mask);; slot = (slot + 1) & header->mask)
+			if (!slots[slot] || !TypeTrait::Equals(elements[slots[slot] - 1], value))
+				return slots + slot;
+	}
+
+	/// <summary>
+	/// <para>Add the elements from [first] on, each only if no earlier one equals it. Returns false if the table got more than half full.</para>
+	/// </summary>
+	bool AddElements(Header* header, size_t first)const
+	{
+		const Type* elements = list.GetConstData();
+		size_t size = list.GetSize();
+
+		for (size_t element = first; element < size; ++element)
+		{
+			size_t* slot = Probe(header, elements, elements[element]);
+			if (*slot)
+				continue;
+
+			if ((header->used + 1) * 2 > header->mask + 1)
+				return false;
+
+			*slot = element + 1;
+			++header->used;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Sized for the capacity of the list, so the appends that fit in the block fit in the index too.</para>
+	/// </summary>
+	Header* BuildIndex()const
+	{
+		size_t capacity = list.GetCapacity() > list.GetSize() ? list.GetCapacity() : list.GetSize();
+		size_t slotCount = MinimumSlots;
+		while (slotCount < capacity * 2)
+			slotCount *= 2;
+
+		AllocPolicy policy(list.GetAllocPolicy());
+		Header* header = (Header*)policy.Allocate(CalculateIndexSize(slotCount));
+		Allocator<Header>::ParameterConstruct(header, slotCount - 1);
+		::memset((void*)GetSlots(header), 0, slotCount * sizeof(size_t));
+
+		bool added = AddElements(header, 0);
+		assert(added); // Twice the elements, never more than half full.
+		(void)added;
+		return header;
+	}
+
+	void ReleaseIndex(Header* header)const
+	{
+		if (header && header->count.DecrementRef())
+		{
+			AllocPolicy policy(list.GetAllocPolicy());
+			policy.Free((void*)header, CalculateIndexSize(header->mask + 1));
+		}
+	}
+
+	/// <summary>
+	/// <para>The index of the current elements, built and published if there is none. The builder that loses the race frees its own.</para>
+	/// </summary>
+	Header* AcquireIndex()const
+	{
+		Header* header = index.load(std::memory_order_acquire);
+		if (header)
+			return header;
+
+		header = BuildIndex();
+		Header* published = nullptr;
+		if (index.compare_exchange_strong(published, header, std::memory_order_acq_rel, std::memory_order_acquire))
+			return header;
+
+		ReleaseIndex(header);
+		return published;
+	}
+
+	/// <summary>
+	/// <para>The elements are about to change in a way the index cannot follow, drop this list's share of it.</para>
+	/// </summary>
+	void DropIndex()
+	{
+		ReleaseIndex(index.load(std::memory_order_relaxed));
+		index.store(nullptr, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// <para>Elements were appended from [first] on. An index of this list alone takes them in, unless it fills up and is built larger later.</para>
+	/// </summary>
+	void IndexAppended(size_t first)
+	{
+		Header* header = index.load(std::memory_order_relaxed);
+		if (header && (header->count.IsShared() || !AddElements(header, first)))
+			DropIndex();
+	}
+
+public:
+	explicit IndexedList(const AllocPolicy& policy = AllocPolicy()) :list(policy), index(nullptr) {}
+
+	IndexedList(const Type* initialData, size_t initialSize, const AllocPolicy& policy = AllocPolicy())
+		:list(initialData, initialSize, policy), index(nullptr)
+	{}
+
+	/// <summary>
+	/// <para>Index the elements of [initialList], sharing its block.</para>
+	/// </summary>
+	explicit IndexedList(const ListType& initialList, const Hash& hash = Hash()) :Hash(hash), list(initialList), index(nullptr) {}
+
+	IndexedList(const Self& other) :Hash(other), list(other.list), index(other.index.load(std::memory_order_acquire))
+	{
+		Header* header = index.load(std::memory_order_relaxed);
+		if (header)
+			header->count.IncrementRef();
+	}
+
+	IndexedList(Self&& other) noexcept :Hash(std::move(other)), list(std::move(other.list)), index(other.index.exchange(nullptr, std::memory_order_relaxed)) {}
+
+	~IndexedList() { ReleaseIndex(index.load(std::memory_order_relaxed)); }
+
+	Self& operator=(const Self& other)
+	{
+		if (this != &other)
+		{
+			Self copy(other);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	Self& operator=(Self&& other) noexcept
+	{
+		if (this != &other)
+		{
+			DropIndex();
+			Hash::operator=(std::move(other));
+			list = std::move(other.list);
+			index.store(other.index.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		return *this;
+	}
+
+	Self& Append(const Type& appendValue)
+	{
+		size_t first = list.GetSize();
+		list.Append(appendValue);
+		IndexAppended(first);
+		return *this;
+	}
+
+	Self& Append(Type&& appendValue)
+	{
+		size_t first = list.GetSize();
+		list.Append(std::move(appendValue));
+		IndexAppended(first);
+		return *this;
+	}
+
+	Self& Append(const Type* appendData, size_t dataSize)
+	{
+		size_t first = list.GetSize();
+		list.Append(appendData, dataSize);
+		IndexAppended(first);
+		return *this;
+	}
+
+	Self& Prepend(const Type& prependValue)
+	{
+		DropIndex();
+		list.Prepend(prependValue);
+		return *this;
+	}
+
+	Self& Insert(size_t insertIndex, const Type& insertValue)
+	{
+		DropIndex();
+		list.Insert(insertIndex, insertValue);
+		return *this;
+	}
+
+	Self& Insert(size_t insertIndex, const Type* insertData, size_t dataSize)
+	{
+		DropIndex();
+		list.Insert(insertIndex, insertData, dataSize);
+		return *this;
+	}
+
+	Self& Delete(size_t deleteIndex, size_t count)
+	{
+		DropIndex();
+		list.Delete(deleteIndex, count);
+		return *this;
+	}
+
+	Self& Empty()
+	{
+		DropIndex();
+		list.Empty();
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>Build the index now, e.g. before searching from several threads, rather than at the first lookup.</para>
+	/// </summary>
+	void Index()const
+	{
+		if (list.GetSize() >= MinimumSize)
+			AcquireIndex();
+	}
+
+	bool IsIndexed()const { return index.load(std::memory_order_acquire); }
+
+	size_t IndexOf(const Type& findValue)const
+	{
+		if (list.GetSize() < MinimumSize)
+			return list.IndexOf(findValue);
+
+		size_t slot = *Probe(AcquireIndex(), list.GetConstData(), findValue);
+		return slot ? slot - 1 : -1;
+	}
+
+	bool IsExist(const Type& findValue)const { return IndexOf(findValue) != (size_t)-1; }
+
+	size_t LastIndexOf(const Type& findValue)const { return list.LastIndexOf(findValue); }
+	size_t Count(const Type& findValue)const { return list.Count(findValue); }
+
+	bool IsEmpty()const { return list.IsEmpty(); }
+
+	size_t GetSize()const { return list.GetSize(); }
+	size_t GetCount()const { return list.GetSize(); }
+	size_t GetLength()const { return list.GetSize(); }
+
+	/// <summary>
+	/// <para>The elements may be written through it, so the index is dropped.</para>
+	/// </summary>
+	Type* GetData()
+	{
+		DropIndex();
+		return list.GetData();
+	}
+
+	const Type* GetConstData()const { return list.GetConstData(); }
+
+	/// <summary>
+	/// <para>The elements as a List, copying it only shares the block.</para>
+	/// </summary>
+	const ListType& GetList()const { return list; }
+};
@@ -1,7 +1,9 @@
 ﻿// List Debug.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
 //
 
+#ifdef _MSC_VER
 #include<crtdbg.h>
+#endif
 #include <iostream>
 #include<string>
 #include"Allocator.h"
@@ -10,7 +12,9 @@
 
 int main()
 {
+#ifdef _MSC_VER
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF); // Memory Detector
+#endif
 
 	char arr[] = { '1','2','5','4','6' };
 	List<char> list1(arr, 4);
@@ -1,31 +1,101 @@
 #pragma once
 
+#include<algorithm>
 #include<cassert>
+#include<cstdlib>
+#include<cstring>
+#include<utility>
 #include"ReferenceCount.h"
 #include"Allocator.h"
+#include"GrowthPolicy.h"
 #include"TypeTrait.h"
+#include"SimdSearch.h"
+#include"RadixSort.h"
 
 
 namespace EscapistPrivate
 {
-	template<typename Type>
-	class ListCore
+	enum class ListEditKind :char
+	{
+		Insert,
+		Delete,
+		Replace
+	};
+
+	/// <summary>
+	/// <para>One recorded edit of a batch, by the index in the list before the batch.</para>
+	/// <para>The inserted or replacing elements are [count] elements from [value] of the editor's own list.</para>
+	/// </summary>
+	struct ListEdit
+	{
+		size_t index;
+		size_t count;
+		size_t value;
+		ListEditKind kind;
+
+		/// <summary>
+		/// <para>At one index, the inserts come first, then the deletes, then the replacements, each kind in recording order.</para>
+		/// </summary>
+		bool operator<(const ListEdit& other)const { return index < other.index || (index == other.index && kind < other.kind); }
+	};
+
+	template<typename Type, typename AllocPolicy = MallocPolicy, size_t InlineCapacity = 0, typename GrowthPolicy = HalfGrowthPolicy, typename ReferencePolicy = AtomicReferencePolicy>
+	class ListCore :private AllocPolicy // Empty base, so a stateless policy costs nothing.
 	{
 	public:
-		using Self = typename ListCore<Type>;
+		using Self = ListCore<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
 		using TypeTrait = typename TypeTraitPatternSelector<Type>::TypeTrait;
+		using Statistics = ListStatistics<Type>;
+		using SharedCount = ReferenceCount<ReferencePolicy>;
 
 		static constexpr size_t MinimumCapacity = (32 / sizeof(Type));
 		static constexpr bool EnableMinimumCapacity = MinimumCapacity;
 
+		static constexpr bool EnableInline = InlineCapacity;
+
+		/// <summary>
+		/// <para>The start of every heap block, the elements follow it. Sharing only counts in it, nothing is allocated.</para>
+		/// <para>The first sharing records the range of elements constructed in the block, a slice shares only a part of that range,</para>
+		/// <para>and the owner left alone with the block destroys the rest. A block that was never shared has no range.</para>
+		/// </summary>
+		struct BlockHeader
+		{
+			SharedCount count;
+			Type* begin;
+			Type* end;
+
+			BlockHeader() :count(1), begin(nullptr), end(nullptr) {}
+		};
+
+		/// <summary>
+		/// <para>The elements of a heap block start on this boundary, the header is padded up to it.</para>
+		/// <para>It is the alignment of the elements, unless the allocation policy asks for more, as AlignedPolicy does for SIMD loads that never split a cache line.</para>
+		/// <para>With the default policy and elements of at most a word, the header is not padded at all.</para>
+		/// </summary>
+		static constexpr size_t DataAlignment = std::max({ alignof(Type), alignof(BlockHeader), AllocPolicyAlignment<AllocPolicy>::Data });
+		static constexpr size_t HeaderSize = (sizeof(BlockHeader) + DataAlignment - 1) & ~(DataAlignment - 1);
+
+		/// <summary>
+		/// <para>Elements aligned beyond the blocks of the policy, like an alignas(64) type under MallocPolicy, get their blocks through OverAlignedPolicy.</para>
+		/// </summary>
+		static constexpr bool EnableOverAlignment = DataAlignment > AllocPolicyAlignment<AllocPolicy>::Block;
+
+		/// <summary>
+		/// <para>Prepend centers the elements in their block, by whole steps of this many elements, so the first one lands on the boundary.</para>
+		/// </summary>
+		static constexpr size_t FrontStep = DataAlignment / std::min(DataAlignment, sizeof(Type) & (~sizeof(Type) + 1));
+
+		static size_t CenterFront(size_t slack) { return slack / 2 / FrontStep * FrontStep; }
+
 		/// <summary>
 		/// <para>From size, speculate the capacity of the new buffer.</para>
 		/// <para>If the input size is too small, every capacity-growth might cause copy and reallcation.</para>
 		/// <para>To prevent it, for objects possessing small size, there's a minimun capacity for initial buffer.</para>
+		/// <para>Above it, the growth policy decides.</para>
 		/// </summary>
 		/// <param name="initialSize">input size</param>
 		/// <returns></returns>
-		static constexpr size_t CalculateCapacity(size_t initialSize)
+		size_t CalculateCapacity(size_t initialSize)const
 		{
 			if (!initialSize) // The data is nullptr.
 				return 0;
@@ -34,28 +104,313 @@ namespace EscapistPrivate
 				initialSize < MinimumCapacity) // If the size is so small, every growth cause the copy and reallocation, to prevent them!!
 				return MinimumCapacity;
 
-			return initialSize * 1.5;
+			return GrowthPolicy::CalculateCapacity(GetBlockPolicy(GetAllocPolicy()), initialSize, sizeof(Type), CalculateBlockSize(0));
+		}
+
+		/// <summary>
+		/// <para>The size in bytes of a data block, the padded block header plus [blockCapacity] elements.</para>
+		/// </summary>
+		static constexpr size_t CalculateBlockSize(size_t blockCapacity) { return HeaderSize + blockCapacity * sizeof(Type); }
+
+		AllocPolicy& GetAllocPolicy() { return *this; }
+		const AllocPolicy& GetAllocPolicy()const { return *this; }
+
+		/// <summary>
+		/// <para>The policy every data block goes through, [policy] itself unless the elements are over-aligned for it.</para>
+		/// </summary>
+		template<typename Policy>
+		static decltype(auto) GetBlockPolicy(Policy& policy)
+		{
+			if constexpr (EnableOverAlignment)
+				return OverAlignedPolicy<Policy, DataAlignment>(policy);
+			else
+				return (Policy&)policy;
+		}
+
+		/// <summary>
+		/// <para>Every copy and move of elements inside the list goes through these two, so the statistics see their bytes.</para>
+		/// </summary>
+		static void CopyElements(Type* dest, const Type* src, size_t count)
+		{
+			Statistics::Add(ListCounter::CopiedBytes, count * sizeof(Type));
+			TypeTrait::Copy(dest, src, count);
+		}
+
+		static void MoveElements(Type* dest, Type* src, size_t count)
+		{
+			Statistics::Add(ListCounter::MovedBytes, count * sizeof(Type));
+			TypeTrait::Move(dest, src, count);
+		}
+
+		/// <summary>
+		/// <para>The elements live inside the object, there is no block header but the capacity is set.</para>
+		/// <para>The inline buffer overlays [data], so the class stays relocatable, the elements are reached by GetData().</para>
+		/// </summary>
+		bool IsInline()const { return EnableInline && !ref && capacity; }
+		bool HasStorage()const { return ref || IsInline(); }
+
+		Type* GetData() { return IsInline() ? (Type*)inlineData : data; }
+		const Type* GetData()const { return IsInline() ? (const Type*)inlineData : data; }
+
+		/// <summary>
+		/// <para>A heap block keeps slack on both sides, [data] may start after the first element of the block.</para>
+		/// <para>Prepend and Delete at the front move [data] instead of the elements, [capacity] still counts the whole block.</para>
+		/// </summary>
+		Type* GetBlockData()const { return GetBlockData(ref); }
+		static Type* GetBlockData(BlockHeader* block) { return (Type*)((unsigned char*)block + HeaderSize); }
+		size_t GetFrontCapacity()const { return ref ? (size_t)(data - GetBlockData()) : 0; }
+		size_t GetBackCapacity()const { return capacity - GetFrontCapacity() - size; }
+
+		void InitializeInline(size_t initialSize)
+		{
+			assert(initialSize <= InlineCapacity);
+
+			ref = nullptr;
+			size = initialSize;
+			capacity = InlineCapacity;
+		}
+
+		/// <summary>
+		/// <para>Move the inline elements to a new data block, leaving [gapSize] uninitialized elements at [gapIndex].</para>
+		/// </summary>
+		void SpillInline(size_t newCapacity, size_t gapIndex, size_t gapSize)
+		{
+			BlockHeader* block = (BlockHeader*)GetBlockPolicy(GetAllocPolicy()).Allocate(CalculateBlockSize(newCapacity));
+			Type* blockData = GetBlockData(block);
+			Type* inlineElements = (Type*)inlineData;
+
+			Statistics::Add(ListCounter::Allocations);
+			Statistics::AddPeakCapacity(newCapacity);
+
+			Allocator<BlockHeader>::DefaultConstruct(block);
+			MoveElements(blockData, inlineElements, gapIndex);
+			MoveElements(blockData + gapIndex + gapSize, inlineElements + gapIndex, size - gapIndex);
+
+			// [data] is assigned last, it overwrites the inline buffer.
+			ref = block;
+			data = blockData;
+			capacity = newCapacity;
+		}
+
+		/// <summary>
+		/// <para>Open a gap of [growthSize] at [growthIndex] of an inline or null list, spilling to the heap when it no longer fits.</para>
+		/// <para>Returns false for a null list too large for the inline buffer, it then takes the heap path as usual.</para>
+		/// </summary>
+		bool GrowthInline(size_t growthIndex, size_t growthSize)
+		{
+			if (size + growthSize <= InlineCapacity)
+			{
+				if (!capacity)
+					InitializeInline(0);
+
+				Type* inlineElements = (Type*)inlineData;
+				MoveElements(inlineElements + growthIndex + growthSize, inlineElements + growthIndex, size - growthIndex);
+				size += growthSize;
+				return true;
+			}
+
+			if (capacity)
+			{
+				SpillInline(CalculateCapacity(size + growthSize), growthIndex, growthSize);
+				size += growthSize;
+				return true;
+			}
+
+			return false;
 		}
 
 		/// <summary>
 		/// <para>Allocate the data, the capacity is only related to the parameter, rather than the member variable.</para>
-		/// <para>The allocated data contains a reference count pointer, and certain continuous sized buffer.</para>
+		/// <para>The allocated data contains the block header, and certain continuous sized buffer.</para>
 		/// </summary>
 		/// <param name="initialCapacity">input capacity</param>
 		void AllocateData(size_t initialCapacity)
 		{
-			ref = Allocator<ReferenceCount*>::Allocate(sizeof(ReferenceCount*) + initialCapacity * sizeof(Type));
+			ref = (BlockHeader*)GetBlockPolicy(GetAllocPolicy()).Allocate(CalculateBlockSize(initialCapacity));
+
+			Statistics::Add(ListCounter::Allocations);
+			Statistics::AddPeakCapacity(initialCapacity);
 
-			*ref = nullptr; // For new object, the reference count is unused. So must assign them as nullptr.
-			data = (Type*)(ref + 1); // Ensuring the data points to the correct place.
+			Allocator<BlockHeader>::DefaultConstruct(ref); // For new object, the block is ours alone and no range is recorded.
+			data = GetBlockData(); // Ensuring the data points to the correct place, past the padded header.
 
 			// PS: MUST ensure this class is always relocatable!
 		}
 
+		/// <summary>
+		/// <para>Resize the unshared data in place if the policy can, the block header travels with it.</para>
+		/// <para>Elements that are not relocatable cannot go through realloc, the first [elementCount] are moved one by one.</para>
+		/// </summary>
+		void ReallocateData(size_t oldCapacity, size_t newCapacity, size_t elementCount)
+		{
+			size_t front = GetFrontCapacity();
+
+			Statistics::Add(ListCounter::Reallocations);
+			Statistics::AddPeakCapacity(newCapacity);
+
+			if (TypeTrait::IsRelocatable)
+			{
+				BlockHeader* old = ref;
+				ref = (BlockHeader*)GetBlockPolicy(GetAllocPolicy()).Reallocate((void*)ref, CalculateBlockSize(oldCapacity), CalculateBlockSize(newCapacity));
+				data = GetBlockData() + front;
+
+				if (ref != old)
+					Statistics::Add(ListCounter::MovedReallocations);
+			}
+			else
+			{
+				Statistics::Add(ListCounter::MovedReallocations);
+
+				BlockHeader* old = ref;
+				Type* oldData = data;
+
+				AllocateData(newCapacity);
+				data += front;
+				MoveElements(data, oldData, elementCount);
+
+				FreeData(old, oldCapacity);
+			}
+		}
+
+		void FreeData(BlockHeader* block, size_t blockCapacity) { GetBlockPolicy(GetAllocPolicy()).Free((void*)block, CalculateBlockSize(blockCapacity)); }
+
+		/// <summary>
+		/// <para>Give up a shared [block] after its elements are copied, never before, another owner may be left alone with it meanwhile.</para>
+		/// <para>The others may also all have left since IsShared, then the decrement makes this one the last, which destroys and frees the block.</para>
+		/// </summary>
+		void LeaveShared(BlockHeader* block, size_t blockCapacity)
+		{
+			if (block->count.DecrementRef())
+			{
+				TypeTrait::Destroy(block->begin, block->end - block->begin);
+				FreeData(block, blockCapacity);
+			}
+		}
+
+		/// <summary>
+		/// <para>Move the elements to a new block of [newCapacity], [newFront] elements after its start, leaving [gapSize] uninitialized elements at [gapIndex].</para>
+		/// <para>The size already counts the gap. A [shared] block is copied and left to its other owners.</para>
+		/// <para>[shared] is what the caller decided, a block it found unshared is already Unshared. Checking again could see the others gone</para>
+		/// <para>in between, and move the view alone out of a block whose elements outside it would never be destroyed.</para>
+		/// </summary>
+		void RebuildData(size_t newCapacity, size_t newFront, size_t gapIndex, size_t gapSize, bool shared)
+		{
+			BlockHeader* old = ref;
+			Type* oldData = data;
+			size_t oldCapacity = capacity;
+			size_t oldSize = size - gapSize;
+
+			AllocateData(newCapacity);
+			data += newFront;
+			capacity = newCapacity;
+
+			if (shared)
+			{
+				Statistics::Add(ListCounter::Detaches);
+				CopyElements(data, oldData, gapIndex);
+				CopyElements(data + gapIndex + gapSize, oldData + gapIndex, oldSize - gapIndex);
+
+				LeaveShared(old, oldCapacity);
+			}
+			else
+			{
+				MoveElements(data, oldData, gapIndex);
+				MoveElements(data + gapIndex + gapSize, oldData + gapIndex, oldSize - gapIndex);
+
+				FreeData(old, oldCapacity);
+			}
+		}
+
+		/// <summary>
+		/// <para>Slide the elements inside the unshared block so [newFront] elements are free before them, leaving a gap like RebuildData.</para>
+		/// </summary>
+		void ShiftData(size_t newFront, size_t gapIndex, size_t gapSize)
+		{
+			Type* oldData = data;
+			Type* newData = GetBlockData() + newFront;
+			size_t oldSize = size - gapSize;
+
+			// Whichever part moves away from the other goes first, so no element is overwritten before it moves.
+			if (newData <= oldData)
+			{
+				MoveElements(newData, oldData, gapIndex);
+				MoveElements(newData + gapIndex + gapSize, oldData + gapIndex, oldSize - gapIndex);
+			}
+			else
+			{
+				MoveElements(newData + gapIndex + gapSize, oldData + gapIndex, oldSize - gapIndex);
+				MoveElements(newData, oldData, gapIndex);
+			}
+
+			data = newData;
+		}
+
+		/// <summary>
+		/// <para>Open a gap of [growthSize] at [growthIndex] of a heap list, the size already counts it.</para>
+		/// <para>Only the shorter part of the list moves into the slack on its side, moving the longer one could cost O(n) every time.</para>
+		/// <para>Without room there, the elements are slid inside the block if a quarter of it stays free, or moved to a larger block.</para>
+		/// <para>Growing near the front centers the elements, so repeated Prepend only moves [data] back and is amortized O(1).</para>
+		/// </summary>
+		void GrowthBlock(size_t growthIndex, size_t growthSize)
+		{
+			size_t oldSize = size - growthSize;
+			bool nearFront = growthIndex < oldSize - growthIndex;
+
+			if (ref->count.IsShared())
+			{
+				size_t newCapacity = CalculateCapacity(size);
+				return RebuildData(newCapacity, nearFront ? CenterFront(newCapacity - size) : 0, growthIndex, growthSize, true);
+			}
+
+			if (ref->begin)
+				Unshare(oldSize);
+
+			size_t front = GetFrontCapacity();
+			size_t back = capacity - front - oldSize;
+
+			if (nearFront && growthSize <= front)
+			{
+				MoveElements(data - growthSize, data, growthIndex);
+				data -= growthSize;
+			}
+			else if (!nearFront && growthSize <= back)
+				MoveElements(data + growthIndex + growthSize, data + growthIndex, oldSize - growthIndex);
+			else if (capacity >= size + size / 4)
+				ShiftData(nearFront ? CenterFront(capacity - size) : 0, growthIndex, growthSize);
+			else if (growthIndex == oldSize)
+			{
+				size_t oldCapacity = capacity;
+				capacity = front + CalculateCapacity(size);
+
+				ReallocateData(oldCapacity, capacity, oldSize);
+			}
+			else
+			{
+				size_t newCapacity = CalculateCapacity(size);
+				RebuildData(newCapacity, nearFront ? CenterFront(newCapacity - size) : 0, growthIndex, growthSize, false);
+			}
+		}
+
+		/// <summary>
+		/// <para>Called by the only owner left of a block that was shared, before it changes the block or frees it.</para>
+		/// <para>The elements outside its [viewSize] elements from [data] are destroyed and the range is forgotten, the block is plainly ours again.</para>
+		/// </summary>
+		void Unshare(size_t viewSize)
+		{
+			TypeTrait::Destroy(ref->begin, data - ref->begin);
+			TypeTrait::Destroy(data + viewSize, ref->end - (data + viewSize));
+
+			ref->begin = nullptr;
+			ref->end = nullptr;
+		}
+
 		void InitializeCore(size_t initialSize, size_t initialCapacity)
 		{
 			assert(initialCapacity >= initialSize); // Check the validity.
 
+			if (EnableInline && initialCapacity <= InlineCapacity)
+				return InitializeInline(initialSize);
+
 			// Assignments
 			size = initialSize;
 			capacity = initialCapacity;
@@ -63,384 +418,827 @@ namespace EscapistPrivate
 			AllocateData(initialCapacity);
 		}
 
-		void InitializeCore(size_t initialSize) { return InitializeCore(initialSize, CalculateCapacity(initialSize)); }
+		void InitializeCore(size_t initialSize)
+		{
+			if (EnableInline && initialSize <= InlineCapacity)
+				return InitializeInline(initialSize);
+
+			return InitializeCore(initialSize, CalculateCapacity(initialSize));
+		}
+
+		void ResetCore()
+		{
+			ref = nullptr;
+			data = nullptr;
+			size = 0;
+			capacity = 0;
+		}
+
+		/// <summary>
+		/// <para>Share the data of the other one, the first sharing records the range of its elements.</para>
+		/// <para>Many threads may share one list at once, the increment elects the one that records, the others do not touch the range.</para>
+		/// <para>Their lists read it only once they are alone with the block again, after the recording one has left it.</para>
+		/// </summary>
+		void ShareCore(const Self& other)
+		{
+			ref = other.ref;
+			data = other.data;
+			size = other.size;
+			capacity = other.capacity;
+
+			if (ref->count.IncrementRef() && !ref->begin)
+			{
+				// The block was not shared yet, so its constructed elements are exactly the other one's.
+				Statistics::Add(ListCounter::Shares);
+				ref->begin = data;
+				ref->end = data + size;
+			}
+		}
+
+		/// <summary>
+		/// <para>Share the heap data of the other one, or copy its inline elements.</para>
+		/// </summary>
+		void CopyCore(const Self& other)
+		{
+			static_assert(std::is_copy_constructible_v<Type>, "A list of move-only elements cannot be copied.");
+
+			if (other.IsInline())
+			{
+				InitializeInline(other.size);
+				CopyElements((Type*)inlineData, other.GetData(), other.size);
+			}
+			else if (other.ref && other.data && other.size)
+				ShareCore(other);
+		}
+
+		/// <summary>
+		/// <para>Share [count] elements of the other one from [index], only the reference count is touched.</para>
+		/// <para>The slice copies its elements on the first change, like any other sharing list.</para>
+		/// </summary>
+		void SliceCore(const Self& other, size_t index, size_t count)
+		{
+			static_assert(std::is_copy_constructible_v<Type>, "A list of move-only elements cannot be sliced.");
+			assert(index + count <= other.size);
+
+			if (!count)
+				return;
+
+			if (other.IsInline())
+			{
+				InitializeInline(count);
+				CopyElements((Type*)inlineData, other.GetData() + index, count);
+			}
+			else if (other.ref && other.data)
+			{
+				ShareCore(other);
+				data += index;
+				size = count;
+			}
+		}
+
+		/// <summary>
+		/// <para>Give up the data, the last owner destroys the elements and frees the buffer.</para>
+		/// </summary>
+		void ReleaseCore()
+		{
+			if (IsInline())
+				TypeTrait::Destroy((Type*)inlineData, size);
+			else if (ref && data)
+			{
+				// Owners racing to leave each decrement, only the last one goes on.
+				if (ref->count.IsShared() && !ref->count.DecrementRef())
+					return;
+
+				if (ref->begin)
+					Unshare(size);
+
+				TypeTrait::Destroy(data, size);
+				FreeData(ref, capacity);
+			}
+		}
 
 	public:
-		ReferenceCount** ref;
-		Type* data;
+		BlockHeader* ref;
+		union
+		{
+			Type* data;
+			alignas(Type) unsigned char inlineData[EnableInline ? InlineCapacity * sizeof(Type) : 1];
+		};
 		size_t size;
 		size_t capacity;
 
-		ListCore()
-			:ref(nullptr), data(nullptr), size(0), capacity(0)
+		ListCore(const AllocPolicy& policy = AllocPolicy())
+			:AllocPolicy(policy), ref(nullptr), data(nullptr), size(0), capacity(0)
 		{}
 
-		ListCore(size_t initialSize)
+		ListCore(size_t initialSize, const AllocPolicy& policy = AllocPolicy())
+			:AllocPolicy(policy)
 		{
 			InitializeCore(initialSize);
 		}
 
-		ListCore(size_t initialSize, size_t initialCapacity)
+		ListCore(size_t initialSize, size_t initialCapacity, const AllocPolicy& policy = AllocPolicy())
+			:AllocPolicy(policy)
 		{
 			InitializeCore(initialSize, initialCapacity);
 		}
 
-		ListCore(const Type* initialData, size_t initialSize)
+		ListCore(const Type* initialData, size_t initialSize, const AllocPolicy& policy = AllocPolicy())
+			:AllocPolicy(policy), ref(nullptr), data(nullptr), size(0), capacity(0)
 		{
 			if (initialData && initialSize)
 			{
 				InitializeCore(initialSize);
-				TypeTrait::Copy(data, initialData, initialSize);
+				CopyElements(GetData(), initialData, initialSize);
 			}
-			else
-				new(this)Self();
 		}
 
 		ListCore(const Self& other)
+			:AllocPolicy(other.GetAllocPolicy()), ref(nullptr), data(nullptr), size(0), capacity(0)
 		{
-			if (other.ref && other.data && other.size)
-			{
-				ref = other.ref;
-				data = other.data;
-				size = other.size;
-				capacity = other.capacity;
+			CopyCore(other);
+		}
 
-				if ((*ref))
-				{
-					(*ref)->IncrementRef();
-				}
-				else
-				{
-					Allocator<ReferenceCount>::Allocate((*ref));
-					Allocator<ReferenceCount>::ParameterConstruct<const int&>((*ref), 2);
-				}
-			}
+		/// <summary>
+		/// <para>Take over the data of the other one, which is left null, no reference count is touched.</para>
+		/// <para>Inline elements are relocated through TypeTrait::Move, like every other move of elements in this class.</para>
+		/// </summary>
+		ListCore(Self&& other) noexcept
+			:AllocPolicy(other.GetAllocPolicy()), ref(other.ref), data(nullptr), size(other.size), capacity(other.capacity)
+		{
+			if (other.IsInline())
+				MoveElements((Type*)inlineData, (Type*)other.inlineData, other.size);
 			else
-				new(this)Self();
+				data = other.data;
+
+			other.ResetCore();
 		}
 
 		ListCore(const Self& other, size_t size)
+			:AllocPolicy(other.GetAllocPolicy()), ref(nullptr), data(nullptr), size(0), capacity(0)
 		{
 			if (size == other.size)
-				new(this)Self(other);
+				CopyCore(other);
+			else if (size && !other.IsEmpty())
+				SliceCore(other, 0, size);
+		}
 
-			if (size && other.ref && other.data && other.size)
-				new(this)Self(other.data, size);
-			else
-				new(this)Self();
+		ListCore(const Self& other, size_t index, size_t count)
+			:AllocPolicy(other.GetAllocPolicy()), ref(nullptr), data(nullptr), size(0), capacity(0)
+		{
+			SliceCore(other, index, count);
 		}
 
 		~ListCore()
 		{
-			if (ref && data)
-			{
-				if (*ref)
-				{
-					if ((*ref)->IsShared())
-					{
-						(*ref)->DecrementRef();
-						return;
-					}
-					else
-					{
-						Allocator<ReferenceCount>::Free((*ref));
-					}
-				}
+			ReleaseCore();
+		}
 
-				TypeTrait::Destroy(data, size);
-				Allocator<ReferenceCount*>::Free(ref);
-			}
+		/// <summary>
+		/// <para>Take over a block of [blockCapacity] elements allocated by our policy, its [count] elements start [front] elements in.</para>
+		/// <para>The first bytes of the block become the block header, whatever they held before.</para>
+		/// </summary>
+		void AdoptBlock(void* block, size_t blockCapacity, size_t front, size_t count)
+		{
+			assert(!HasStorage() && front + count <= blockCapacity);
+
+			ref = (BlockHeader*)block;
+			Allocator<BlockHeader>::DefaultConstruct(ref);
+			data = GetBlockData() + front;
+			size = count;
+			capacity = blockCapacity;
+
+			Statistics::AddPeakCapacity(blockCapacity);
 		}
 
 		void Detach(bool copyData)
 		{
 			if (ref && data && size)
 			{
-				if ((*ref) && (*ref)->IsShared())
+				if (ref->count.IsShared())
 				{
-					(*ref)->DecrementRef();
+					Statistics::Add(ListCounter::Detaches);
 
+					BlockHeader* old = ref;
 					Type* oldData = data;
-					capacity = size * 1.5;
+					size_t oldCapacity = capacity;
+					capacity = CalculateCapacity(size);
 
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = nullptr;
-					data = (Type*)(ref + 1);
+					AllocateData(capacity);
 					if (copyData)
-						TypeTrait::Copy(data, oldData, size);
+						CopyElements(data, oldData, size);
+
+					LeaveShared(old, oldCapacity);
 				}
 			}
 		}
 
+		/// <summary>
+		/// <para>Make room for [newCapacity] elements from [data] on, the front slack is kept.</para>
+		/// </summary>
 		void EnsureCapacity(size_t newCapacity)
 		{
-			if (capacity < newCapacity)
+			if (GetCapacity() < newCapacity)
 			{
-				if (ref && data && size)
+				if (EnableInline && !ref)
 				{
-					if ((*ref) && (*ref)->IsShared())
+					if (newCapacity <= InlineCapacity)
+						return InitializeInline(0);
+
+					if (capacity)
+						return SpillInline(newCapacity, size, 0);
+				}
+
+				if (ref)
+				{
+					if (ref->count.IsShared())
 					{
-						(*ref)->DecrementRef();
+						Statistics::Add(ListCounter::Detaches);
 
+						BlockHeader* old = ref;
 						Type* oldData = data;
+						size_t oldCapacity = capacity;
 						capacity = newCapacity;
 
-						Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-						(*ref) = nullptr;
-						data = (Type*)(ref + 1);
-						TypeTrait::Copy(data, oldData, size);
+						AllocateData(capacity);
+						CopyElements(data, oldData, size);
+
+						LeaveShared(old, oldCapacity);
 					}
 					else
 					{
-						ReferenceCount** old = ref;
-						capacity = newCapacity;
+						if (ref->begin)
+							Unshare(size);
 
-						Allocator<ReferenceCount*>::Reallocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-						if (ref != old)
-							data = (Type*)(ref + 1);
+						size_t oldCapacity = capacity;
+						capacity = GetFrontCapacity() + newCapacity;
+
+						ReallocateData(oldCapacity, capacity, size);
 					}
 				}
 				else
 				{
 					capacity = newCapacity;
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = nullptr;
-					data = (Type*)(ref + 1);
+					AllocateData(capacity);
 				}
 			}
 		}
 
+		/// <summary>
+		/// <para>Move the unshared heap elements to the start of a block of [newCapacity], the slack on both sides goes back.</para>
+		/// <para>An empty list frees its block, and one that fits in the inline buffer returns to it.</para>
+		/// </summary>
+		void ShrinkData(size_t newCapacity)
+		{
+			assert(ref && !IsShared() && newCapacity >= size);
+
+			if (ref->begin)
+				Unshare(size);
+
+			if (!size)
+			{
+				FreeData(ref, capacity);
+				return ResetCore();
+			}
+
+			if (EnableInline && size <= InlineCapacity)
+			{
+				BlockHeader* old = ref;
+				Type* oldData = data;
+				size_t oldCapacity = capacity;
+
+				// The inline buffer overwrites [data], which is saved above.
+				InitializeInline(size);
+				MoveElements((Type*)inlineData, oldData, size);
+				return FreeData(old, oldCapacity);
+			}
+
+			if (TypeTrait::IsRelocatable)
+			{
+				if (GetFrontCapacity())
+					ShiftData(0, size, 0);
+
+				size_t oldCapacity = capacity;
+				capacity = newCapacity;
+
+				ReallocateData(oldCapacity, capacity, size);
+			}
+			else
+				RebuildData(newCapacity, 0, size, 0, false);
+		}
+
+		/// <summary>
+		/// <para>Give all the slack back. A shared block is left as it is, its other owners still use it.</para>
+		/// </summary>
+		void ShrinkToFit()
+		{
+			if (ref && !IsShared() && (capacity > size || (EnableInline && size <= InlineCapacity)))
+				ShrinkData(size);
+		}
+
 		Type* GrowthAppend(size_t growthSize)
 		{
 			if (!growthSize)
-				return data + size;
+				return GetData() + size;
 
-			if (ref && data && size)
+			if (EnableInline && !ref && GrowthInline(size, growthSize))
+				return GetData() + size - growthSize;
+
+			if (ref)
 			{
 				size_t oldSize = size;
 				size += growthSize;
 
-				if ((*ref) && (*ref)->IsShared())
+				if (ref->count.IsShared() || ref->begin || GetFrontCapacity() + size > capacity)
+					GrowthBlock(oldSize, growthSize);
+				return data + oldSize;
+			}
+			else
+			{
+				size = growthSize;
+				capacity = CalculateCapacity(size);
+				AllocateData(capacity);
+				return data;
+			}
+		}
+
+		void GrowthPrepend(size_t growthSize)
+		{
+			if (ref && !ref->count.IsShared() && !ref->begin && GetFrontCapacity() >= growthSize)
+			{
+				data -= growthSize;
+				size += growthSize;
+			}
+			else
+				GrowthInsert(0, growthSize);
+		}
+
+		void GrowthInsert(size_t growthIndex, size_t growthSize)
+		{
+			if (!growthSize)
+				return;
+
+			if (EnableInline && !ref && GrowthInline(growthIndex, growthSize))
+				return;
+
+			if (ref)
+			{
+				size += growthSize;
+				GrowthBlock(growthIndex, growthSize);
+			}
+			else
+			{
+				size = growthSize;
+				capacity = CalculateCapacity(size);
+				AllocateData(capacity);
+			}
+		}
+
+		void Delete(size_t index, size_t count)
+		{
+			if (!count)
+				return;
+
+			size_t oldSize = size;
+			size -= count;
+
+			if (HasStorage() && oldSize)
+			{
+				if (ref && ref->count.IsShared())
 				{
-					(*ref)->DecrementRef();
+					if (!size) // Nothing left to copy, just leave the data to the other owners.
+					{
+						LeaveShared(ref, capacity);
+						return ResetCore();
+					}
 
+					Statistics::Add(ListCounter::Detaches);
+					BlockHeader* old = ref;
 					Type* oldData = data;
+					size_t oldCapacity = capacity;
 					capacity = CalculateCapacity(size);
 
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = nullptr;
-					data = (Type*)(ref + 1);
-					TypeTrait::Copy(data, oldData, oldSize);
+					AllocateData(capacity);
+					CopyElements(data, oldData, index);
+					CopyElements(data + index, oldData + index + count, oldSize - index - count);
+
+					LeaveShared(old, oldCapacity);
 				}
-				else if (size > capacity)
+				else
 				{
-					ReferenceCount** old = ref;
-					capacity = CalculateCapacity(size);
+					if (ref && ref->begin)
+						Unshare(oldSize);
+
+					Type* elements = GetData();
+					TypeTrait::Destroy(elements + index, count);
+
+					if (ref && index < size - index) // The front is shorter, it moves and [data] follows.
+					{
+						MoveElements(elements + count, elements, index);
+						data += count;
+					}
+					else
+						MoveElements(elements + index, elements + index + count, oldSize - index - count);
 
-					Allocator<ReferenceCount*>::Reallocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					if (ref != old)
-						data = (Type*)(ref + 1);
+					if (ref && !size) // All the slack goes back to the end.
+						data = GetBlockData();
 
-					return data + oldSize;
-					//::memcpy((void*)ref, (const void*)old, sizeof(ReferenceCount**) + size * sizeof(Type));
+					if constexpr (GrowthPolicy::ShrinkRatio != 0)
+					{
+						if (ref && capacity > MinimumCapacity && size * GrowthPolicy::ShrinkRatio < capacity)
+							ShrinkData(CalculateCapacity(size));
+					}
 				}
 			}
+		}
+
+		void Empty()
+		{
+			if (HasStorage() && size)
+			{
+				if (ref && ref->count.IsShared())
+				{
+					LeaveShared(ref, capacity);
+					ResetCore();
+				}
+				else
+				{
+					if (ref && ref->begin)
+						Unshare(size);
+
+					TypeTrait::Destroy(GetData(), size);
+					size = 0; 
+
+					if (ref)
+						data = GetBlockData();
+				}
+			}
+		}
+
+		/// <summary>
+		/// <para>Bring the elements before [end] to [target], from [position] on, except the ones deleted up to [deleteEnd].</para>
+		/// <para>A shared list copies them and leaves its block alone, otherwise they are moved and the deleted ones destroyed.</para>
+		/// </summary>
+		void TransferEdited(Type*& target, size_t& position, size_t deleteEnd, size_t end, bool shared)
+		{
+			if (end <= position)
+				return;
+
+			Type* elements = GetData();
+			size_t begin = position < deleteEnd ? (deleteEnd < end ? deleteEnd : end) : position;
+
+			if (!shared)
+				TypeTrait::Destroy(elements + position, begin - position);
+
+			position = end;
+			if (begin == end)
+				return;
+
+			if (shared)
+				CopyElements(target, elements + begin, end - begin);
 			else
+				MoveElements(target, elements + begin, end - begin);
+
+			target += end - begin;
+		}
+
+		/// <summary>
+		/// <para>Apply [editCount] sorted edits in one pass, into one new block of the final size.</para>
+		/// <para>The elements of [values] are moved in, or destroyed when their edit is overruled, [values] is left empty.</para>
+		/// <para>Deletes may overlap. A replacement of a deleted element is dropped, of one replaced again the last one wins.</para>
+		/// </summary>
+		void ApplyEdits(const ListEdit* edits, size_t editCount, Self& values)
+		{
+			if (!editCount)
+				return;
+
+			if (ref && !ref->count.IsShared() && ref->begin)
+				Unshare(size);
+
+			bool shared = IsShared();
+			if (shared)
+				Statistics::Add(ListCounter::Detaches);
+
+			size_t newSize = size;
+			size_t deleteEnd = 0;
+			for (size_t index = 0; index < editCount; ++index)
 			{
-				size = growthSize;
-				capacity = CalculateCapacity(size);
-				Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-				(*ref) = nullptr;
-				data = (Type*)(ref + 1);
-				return data;
+				const ListEdit& edit = edits[index];
+				if (edit.kind == ListEditKind::Insert)
+					newSize += edit.count;
+				else if (edit.kind == ListEditKind::Delete && edit.index + edit.count > deleteEnd)
+				{
+					newSize -= edit.index + edit.count - (edit.index > deleteEnd ? edit.index : deleteEnd);
+					deleteEnd = edit.index + edit.count;
+				}
 			}
+
+			Self rebuilt(GetAllocPolicy());
+			if (newSize)
+				rebuilt.InitializeCore(newSize);
+
+			Type* target = rebuilt.GetData();
+			Type* value = values.GetData();
+			Type* elements = GetData();
+			size_t position = 0;
+			deleteEnd = 0;
+
+			for (size_t index = 0; index < editCount; ++index)
+			{
+				const ListEdit& edit = edits[index];
+				TransferEdited(target, position, deleteEnd, edit.index, shared);
+
+				if (edit.kind == ListEditKind::Insert)
+				{
+					MoveElements(target, value + edit.value, edit.count);
+					target += edit.count;
+				}
+				else if (edit.kind == ListEditKind::Delete)
+				{
+					if (edit.index + edit.count > deleteEnd)
+						deleteEnd = edit.index + edit.count;
+				}
+				else if (edit.index < deleteEnd || edit.index < position ||
+					(index + 1 < editCount && edits[index + 1].kind == ListEditKind::Replace && edits[index + 1].index == edit.index))
+					TypeTrait::Destroy(value + edit.value, edit.count);
+				else
+				{
+					if (!shared)
+						TypeTrait::Destroy(elements + edit.index);
+
+					MoveElements(target, value + edit.value, 1);
+					++target;
+					position = edit.index + 1;
+				}
+			}
+			TransferEdited(target, position, deleteEnd, size, shared);
+
+			assert(target == rebuilt.GetData() + newSize);
+			values.size = 0;
+
+			// The elements are all gone to the new block, unless other owners still use them.
+			if (!shared)
+				size = 0;
+
+			this->~ListCore();
+			new(this)Self(std::move(rebuilt));
 		}
 
-		void GrowthPrepend(size_t growthSize)
+		/// <summary>
+		/// <para>Keep only [count] elements from [index]. A shared list narrows its view of the block and copies nothing.</para>
+		/// </summary>
+		void Narrow(size_t index, size_t count)
 		{
-			if (!growthSize)
-				return;
+			assert(index + count <= size);
 
-			if (ref && data && size)
+			if (IsShared())
 			{
-				size_t oldSize = size;
-				size += growthSize;
-
-				if ((*ref) && (*ref)->IsShared())
+				if (!count)
 				{
-					(*ref)->DecrementRef();
-
-					Type* oldData = data;
-					capacity = CalculateCapacity(size);
-
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = nullptr;
-					data = (Type*)(ref + 1);
-					TypeTrait::Copy(data + growthSize, oldData, oldSize);
+					LeaveShared(ref, capacity);
+					return ResetCore();
 				}
-				else if (size > capacity)
-				{
-					ReferenceCount** old = ref;
-					Type* oldData = data;
-					capacity = CalculateCapacity(size);
 
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = (*old);
-					data = (Type*)(ref + 1);
-					::memcpy((void*)(data + growthSize), (const void*)oldData, oldSize * sizeof(Type));
-
-					::free((void*)old);
-				}
-				else
-					::memmove((void*)(data + growthSize), (const void*)data, oldSize * sizeof(Type));
+				data += index;
+				size = count;
 			}
 			else
 			{
-				size = growthSize;
-				capacity = CalculateCapacity(size);
-				Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-				(*ref) = nullptr;
-				data = (Type*)(ref + 1);
+				Delete(index + count, size - index - count);
+				Delete(0, index);
 			}
 		}
 
-		void GrowthInsert(size_t growthIndex, size_t growthSize)
-		{
-			if (!growthSize)
-				return;
+		/// <summary>
+		/// <para>Integers, enumerations, pointers, float and double with the Pod pattern are searched by the SIMD kernels.</para>
+		/// <para>Their Equals is the plain ==, so the vector compare gives the same answer.</para>
+		/// </summary>
+		static constexpr bool EnableSimdSearch = TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod && Simd::SearchLane<Type>::Enable;
 
-			if (ref && data && size)
+		size_t IndexOf(const Type& value)const
+		{
+			const Type* elements = GetData();
+			if constexpr (EnableSimdSearch)
+				return Simd::IndexOf(elements, size, value);
+			else
 			{
-				size_t oldSize = size;
-				size += growthSize;
+				for (size_t index = 0; index < size; ++index)
+					if (!TypeTrait::Equals(elements[index], value))
+						return index;
 
-				if ((*ref) && (*ref)->IsShared())
-				{
-					(*ref)->DecrementRef();
+				return -1;
+			}
+		}
 
-					Type* oldData = data;
-					capacity = CalculateCapacity(size);
+		size_t LastIndexOf(const Type& value)const
+		{
+			const Type* elements = GetData();
+			if constexpr (EnableSimdSearch)
+				return Simd::LastIndexOf(elements, size, value);
+			else
+			{
+				for (size_t index = size; index > 0; --index)
+					if (!TypeTrait::Equals(elements[index - 1], value))
+						return index - 1;
 
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = nullptr;
-					data = (Type*)(ref + 1);
-					TypeTrait::Copy(data, oldData, growthIndex);
-					TypeTrait::Copy(data + growthIndex + growthSize, oldData + growthIndex, oldSize - growthIndex);
-				}
-				else if (size > capacity)
-				{
-					ReferenceCount** old = ref;
-					Type* oldData = data;
-					capacity = CalculateCapacity(size);
+				return -1;
+			}
+		}
 
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-					(*ref) = (*old);
-					data = (Type*)(ref + 1);
-					::memcpy((void*)(data + growthIndex), (const void*)oldData, growthIndex * sizeof(Type));
-					::memcpy((void*)(data + growthIndex + growthSize), (const void*)oldData, (oldSize - growthIndex) * sizeof(Type));
+		size_t IndexOfAny(const Type* values, size_t valueCount)const
+		{
+			const Type* elements = GetData();
+			if constexpr (EnableSimdSearch)
+				return Simd::IndexOfAny(elements, size, values, valueCount);
+			else
+			{
+				for (size_t index = 0; index < size; ++index)
+					for (size_t value = 0; value < valueCount; ++value)
+						if (!TypeTrait::Equals(elements[index], values[value]))
+							return index;
 
-					::free((void*)old);
-				}
-				else
-					::memmove((void*)(data + growthIndex + growthSize), (const void*)(data + growthIndex), (oldSize - growthIndex) * sizeof(Type));
+				return -1;
 			}
+		}
+
+		size_t Count(const Type& value)const
+		{
+			const Type* elements = GetData();
+			if constexpr (EnableSimdSearch)
+				return Simd::Count(elements, size, value);
 			else
 			{
-				size = growthSize;
-				capacity = CalculateCapacity(size);
-				Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount**) + capacity * sizeof(Type));
-				(*ref) = nullptr;
-				data = (Type*)(ref + 1);
+				size_t count = 0;
+				for (size_t index = 0; index < size; ++index)
+					if (!TypeTrait::Equals(elements[index], value))
+						++count;
+
+				return count;
 			}
 		}
 
-		void Delete(size_t index, size_t count)
-		{
-			if (!count)
-				return;
+		size_t IsExist(const Type& value)const { return IndexOf(value) != (size_t)-1; }
 
-			size_t oldSize = size;
-			size -= count;
+		/// <summary>
+		/// <para>Integers, enumerations, float and double with the Pod pattern are radix sorted by their bytes.</para>
+		/// <para>Their Equals is the plain == and &lt;, so the order of the keys is the order Equals gives.</para>
+		/// </summary>
+		static constexpr bool EnableRadixSort = TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod && Radix::RadixKey<Type>::Enable;
 
-			if (ref && data && size)
-			{
-				if ((*ref) && (*ref)->IsShared())
-				{
-					(*ref)->DecrementRef();
+		static bool IsLess(const Type& left, const Type& right) { return TypeTrait::Equals(left, right) < 0; }
 
-					Type* oldData = data;
-					capacity = CalculateCapacity(size);
+		/// <summary>
+		/// <para>Sort the elements of an unshared list in ascending order. The radix sort borrows a scratch buffer of the size of the elements</para>
+		/// <para>from the policy, every other type is sorted in place by std::sort, an introsort.</para>
+		/// </summary>
+		void Sort()
+		{
+			if (size < 2)
+				return;
 
-					Allocator<ReferenceCount*>::Allocate(ref, sizeof(ReferenceCount*) + capacity * sizeof(Type));
-					(*ref) = nullptr;
-					data = (Type*)(ref + 1);
-					TypeTrait::Copy(data, oldData, index);
-					TypeTrait::Copy(data + index, oldData + index + count, oldSize - index - count);
-				}
-				else
+			Type* elements = GetData();
+			if constexpr (EnableRadixSort)
+			{
+				if (size >= Radix::GetMinimumSize<Type>())
 				{
-					TypeTrait::Destroy(data + index, count);
-					::memcpy(data + index, data + index + count, oldSize - index - count);
+					Type* scratch = (Type*)GetAllocPolicy().Allocate(size * sizeof(Type));
+					Radix::Sort(elements, scratch, size);
+					GetAllocPolicy().Free((void*)scratch, size * sizeof(Type));
+					return;
 				}
 			}
+
+			std::sort(elements, elements + size, [](const Type& left, const Type& right) { return IsLess(left, right); });
 		}
 
-		void Empty()
+		/// <summary>
+		/// <para>Merge the elements of [other] into this list, both sorted by [less], into one new block of the total size.</para>
+		/// <para>The equal elements of this list come first, its elements are moved out of it unless it is shared.</para>
+		/// </summary>
+		template<typename Less>
+		void MergeSorted(const Self& other, const Less& less)
 		{
-			if (ref && data && size)
+			if (!other.size)
+				return;
+
+			if (!size)
 			{
-				if ((*ref) && (*ref)->IsShared())
+				// Nothing to merge into, share the block of [other] as a copy does, if our policy could free it.
+				if (EscapistPrivate::AllocPolicyEquality<AllocPolicy>::IsEqual(GetAllocPolicy(), other.GetAllocPolicy()))
 				{
-					(*ref)->DecrementRef();
-					new(this)Self();
+					this->~ListCore();
+					new(this)Self(other);
+					return;
 				}
+
+				// Otherwise the elements are copied to a block of our own policy, the list stays in its arena.
+				Self copy(GetAllocPolicy());
+				copy.InitializeCore(other.size);
+				CopyElements(copy.GetData(), other.GetData(), other.size);
+
+				this->~ListCore();
+				new(this)Self(std::move(copy));
+				return;
+			}
+
+			if (&other == this)
+			{
+				Self copy(other);
+				return MergeSorted(copy, less);
+			}
+
+			if (ref && !ref->count.IsShared() && ref->begin)
+				Unshare(size);
+
+			bool shared = IsShared();
+			if (shared)
+				Statistics::Add(ListCounter::Detaches);
+
+			Self merged(GetAllocPolicy());
+			merged.InitializeCore(size + other.size);
+
+			Type* target = merged.GetData();
+			Type* elements = GetData();
+			const Type* otherElements = other.GetData();
+			size_t index = 0;
+			size_t otherIndex = 0;
+
+			while (index < size && otherIndex < other.size)
+			{
+				if (less(otherElements[otherIndex], elements[index]))
+					TypeTrait::Copy(target++, otherElements + otherIndex++, 1);
+				else if (shared)
+					TypeTrait::Copy(target++, elements + index++, 1);
 				else
-				{
-					TypeTrait::Destroy(data, size);
-					size = 0; 
-				}
+					TypeTrait::Move(target++, elements + index++, 1);
 			}
-		}
 
-		size_t IndexOf(const Type& value)const
-		{
-			for (size_t index = 0; index < size; ++index)
-				if (TypeTrait::Equals(data[index], value))
-					return index;
+			Statistics::Add(ListCounter::CopiedBytes, (otherIndex + (shared ? index : 0)) * sizeof(Type));
+			Statistics::Add(ListCounter::MovedBytes, (shared ? 0 : index) * sizeof(Type));
 
-			return -1;
-		}
+			if (shared)
+				CopyElements(target, elements + index, size - index);
+			else
+				MoveElements(target, elements + index, size - index);
+			target += size - index;
+			CopyElements(target, otherElements + otherIndex, other.size - otherIndex);
 
-		size_t LastIndexOf(const Type& value)const
-		{
-			for (size_t index = size - 1; index > 0; --index)
-				if (TypeTrait::Equals(data[index], value))
-					return index;
+			assert(target + (other.size - otherIndex) == merged.GetData() + merged.size);
+
+			// The elements are all gone to the new block, unless other owners still use them.
+			if (!shared)
+				size = 0;
 
-			return -1;
+			this->~ListCore();
+			new(this)Self(std::move(merged));
 		}
 
-		size_t IsExist(const Type& value)const { return IndexOf(value) != -1; }
+		bool IsShared()const { return ref && ref->count.IsShared(); }
+		bool IsSharingWith(const Self& other)const { return ref == other.ref && !IsInline() && !other.IsInline(); }
 
-		bool IsShared()const { return (*(ref))->IsShared(); }
-		bool IsSharingWith(const Self& other)const { return ref == other.ref; }
+		/// <summary>
+		/// <para>The elements that fit from [data] on without a new block.</para>
+		/// </summary>
+		size_t GetCapacity()const { return capacity - GetFrontCapacity(); }
 
-		bool IsEmpty()const { return !(ref && data && size); }
-		bool IsNull()const { return !(ref && data && capacity); }
-		bool IsEmptyOrNull()const { return !(ref && data && size && capacity); }
+		bool IsEmpty()const { return !(HasStorage() && size); }
+		bool IsNull()const { return !(HasStorage() && capacity); }
+		bool IsEmptyOrNull()const { return !(HasStorage() && size && capacity); }
 	};
 }
 
-template<typename Type>
+template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+class ListEditor;
+
+class ListSerializer;
+
+template<typename Type, typename AllocPolicy>
+class ConcurrentAppendList;
+
+/// <summary>
+/// <para>Selects the filling constructor, List(size, ListFill, value), which List(size, capacity) could not be told apart from.</para>
+/// </summary>
+struct ListFillTag
+{
+	explicit ListFillTag() = default;
+};
+
+inline constexpr ListFillTag ListFill{};
+
+template<typename Type, typename AllocPolicy = MallocPolicy, size_t InlineCapacity = 0, typename GrowthPolicy = HalfGrowthPolicy, typename ReferencePolicy = AtomicReferencePolicy>
 class List
 {
 private:
-	using Self = typename List<Type>;
-	using Core = typename EscapistPrivate::ListCore<Type>;
+	using Self = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+	using Core = EscapistPrivate::ListCore<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
 	using TypeTrait = typename TypeTraitPatternSelector<Type>::TypeTrait;
 
 	Core core;
 
+	friend class ListEditor<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+	friend class ListSerializer;
+	friend class ConcurrentAppendList<Type, AllocPolicy>;
+
 #ifdef _DEBUG
 public:
 #else
@@ -451,11 +1249,22 @@ private:
 public:
 	List() :core() {}
 
-	List(size_t initialSize) :core(initialSize) {}
+	explicit List(const AllocPolicy& policy) :core(policy) {}
+
+	List(size_t initialSize, const AllocPolicy& policy = AllocPolicy()) :core(initialSize, policy) {}
 
-	List(size_t initialSize, size_t initialCapacity) :core(initialSize, initialCapacity) {}
+	List(size_t initialSize, size_t initialCapacity, const AllocPolicy& policy = AllocPolicy()) :core(initialSize, initialCapacity, policy) {}
 
-	List(const Type* initialData, size_t initialSize) :core(initialData, initialSize) {}
+	List(const Type* initialData, size_t initialSize, const AllocPolicy& policy = AllocPolicy()) :core(initialData, initialSize, policy) {}
+
+	/// <summary>
+	/// <para>[initialSize] copies of [fillValue], filled straight into the new buffer.</para>
+	/// </summary>
+	List(size_t initialSize, ListFillTag, const Type& fillValue, const AllocPolicy& policy = AllocPolicy())
+		:core(initialSize, policy)
+	{
+		TypeTrait::Fill(core.GetData(), fillValue, initialSize);
+	}
 
 	List(const Core& other) :core(other) {}
 
@@ -465,12 +1274,46 @@ public:
 
 	List(const Self& other, size_t size) :core(other.core, size) {}
 
+	/// <summary>
+	/// <para>A slice of [count] elements of the other one from [index], sharing its block until either of them changes.</para>
+	/// </summary>
+	List(const Self& other, size_t index, size_t count) :core(other.core, index, count) {}
+
+	List(Self&& other) noexcept :core(std::move(other.core)) {}
+
+	Self& operator=(const Self& other)
+	{
+		if (this != &other)
+		{
+			Self copy(other); // Before releasing, the other one might live in our own elements.
+			this->~Self();
+			new(this)Self(std::move(copy));
+		}
+		return *this;
+	}
+
+	Self& operator=(Self&& other) noexcept
+	{
+		if (this != &other)
+		{
+			this->~Self();
+			new(this)Self(std::move(other));
+		}
+		return *this;
+	}
+
 	Self& Append(const Type& appendValue)
 	{
 		TypeTrait::Assign(core.GrowthAppend(1), appendValue);
 		return *this;
 	}
 
+	Self& Append(Type&& appendValue)
+	{
+		TypeTrait::Assign(core.GrowthAppend(1), std::move(appendValue));
+		return *this;
+	}
+
 	Self& Append(const Type& appendValue, size_t appendCount)
 	{
 		TypeTrait::Fill(core.GrowthAppend(appendCount), appendValue, appendCount);
@@ -486,15 +1329,16 @@ public:
 
 	Self& Append(const Self& appendList)
 	{
-		if (appendList.core.ref && appendList.core.data && appendList.core.size)
+		if (!appendList.core.IsEmpty())
 		{
-			if (!(core.ref && core.data && core.size))
+			if (core.IsEmpty())
 			{
+				this->~Self();
 				new(this)Self(appendList);
 				return *this;
 			}
 
-			TypeTrait::Copy(core.GrowthAppend(appendList.core.size), appendList.core.data, appendList.core.size);
+			TypeTrait::Copy(core.GrowthAppend(appendList.core.size), appendList.core.GetData(), appendList.core.size);
 		}
 		return *this;
 	}
@@ -504,15 +1348,16 @@ public:
 		if (listSize == appendList.core.size)
 			return Append(appendList);
 
-		if (appendList.core.ref && appendList.core.data && listSize)
+		if (!appendList.core.IsEmpty() && listSize)
 		{
-			if (!(core.ref && core.data && core.size))
+			if (core.IsEmpty())
 			{
-				new(this)Self(appendList);
+				this->~Self();
+				new(this)Self(appendList, listSize);
 				return *this;
 			}
 
-			TypeTrait::Copy(core.GrowthAppend(listSize), appendList.core.data, listSize);
+			TypeTrait::Copy(core.GrowthAppend(listSize), appendList.core.GetData(), listSize);
 		}
 		return *this;
 	}
@@ -521,7 +1366,15 @@ public:
 	{
 		core.GrowthPrepend(1);
 
-		TypeTrait::Assign(core.data, prependValue);
+		TypeTrait::Assign(core.GetData(), prependValue);
+		return *this;
+	}
+
+	Self& Prepend(Type&& prependValue)
+	{
+		core.GrowthPrepend(1);
+
+		TypeTrait::Assign(core.GetData(), std::move(prependValue));
 		return *this;
 	}
 
@@ -529,7 +1382,7 @@ public:
 	{
 		core.GrowthPrepend(prependCount);
 
-		TypeTrait::Fill(core.data, prependValue, prependCount);
+		TypeTrait::Fill(core.GetData(), prependValue, prependCount);
 		return *this;
 	}
 
@@ -538,23 +1391,24 @@ public:
 		if (prependData && dataSize)
 		{
 			core.GrowthPrepend(dataSize);
-			TypeTrait::Copy(core.data, prependData, dataSize);
+			TypeTrait::Copy(core.GetData(), prependData, dataSize);
 		}
 		return *this;
 	}
 
 	Self& Prepend(const Self& prependList)
 	{
-		if (prependList.core.ref && prependList.core.data && prependList.core.size)
+		if (!prependList.core.IsEmpty())
 		{
-			if (!(core.ref && core.data && core.size))
+			if (core.IsEmpty())
 			{
+				this->~Self();
 				new(this)Self(prependList);
 				return *this;
 			}
 
 			core.GrowthPrepend(prependList.core.size);
-			TypeTrait::Copy(core.data, prependList.core.data, prependList.core.size);
+			TypeTrait::Copy(core.GetData(), prependList.core.GetData(), prependList.core.size);
 		}
 		return *this;
 	}
@@ -564,16 +1418,17 @@ public:
 		if (listSize >= prependList.core.size)
 			return Prepend(prependList);
 
-		if (prependList.core.ref && prependList.core.data && listSize)
+		if (!prependList.core.IsEmpty() && listSize)
 		{
-			if (!(core.ref && core.data && core.size))
+			if (core.IsEmpty())
 			{
-				new(this)Self(prependList);
+				this->~Self();
+				new(this)Self(prependList, listSize);
 				return *this;
 			}
 
 			core.GrowthPrepend(listSize);
-			TypeTrait::Copy(core.data, prependList.core.data, listSize);
+			TypeTrait::Copy(core.GetData(), prependList.core.GetData(), listSize);
 		}
 		return *this;
 	}
@@ -581,14 +1436,21 @@ public:
 	Self& Insert(size_t index, const Type& insertValue)
 	{
 		core.GrowthInsert(index, 1);
-		TypeTrait::Assign(core.data + index, insertValue);
+		TypeTrait::Assign(core.GetData() + index, insertValue);
+		return *this;
+	}
+
+	Self& Insert(size_t index, Type&& insertValue)
+	{
+		core.GrowthInsert(index, 1);
+		TypeTrait::Assign(core.GetData() + index, std::move(insertValue));
 		return *this;
 	}
 
 	Self& Insert(size_t index, const Type& insertValue, size_t insertCount)
 	{
 		core.GrowthInsert(index, insertCount);
-		TypeTrait::Fill(core.data + index, insertValue, insertCount);
+		TypeTrait::Fill(core.GetData() + index, insertValue, insertCount);
 		return *this;
 	}
 
@@ -597,22 +1459,24 @@ public:
 		if (insertData && dataSize)
 		{
 			core.GrowthInsert(index, dataSize);
-			TypeTrait::Copy(core.data + index, insertData, dataSize);
+			TypeTrait::Copy(core.GetData() + index, insertData, dataSize);
 		}
 		return *this;
 	}
 
 	Self& Insert(size_t index, const Self& insertList)
 	{
-		if (insertList.core.ref && insertList.core.data && insertList.core.size)
+		if (!insertList.core.IsEmpty())
 		{
-			if (!(core.ref && core.data && core.size))
+			if (core.IsEmpty())
 			{
+				this->~Self();
+				new(this)Self(insertList);
 				return *this;
 			}
 
 			core.GrowthInsert(index, insertList.core.size);
-			TypeTrait::Copy(core.data + index, insertList.core.data, insertList.core.size);
+			TypeTrait::Copy(core.GetData() + index, insertList.core.GetData(), insertList.core.size);
 		}
 		return *this;
 	}
@@ -622,19 +1486,47 @@ public:
 		if (listSize >= insertList.core.size)
 			return Insert(index, insertList);
 
-		if (insertList.core.ref && insertList.core.data && listSize)
+		if (!insertList.core.IsEmpty() && listSize)
 		{
-			if (!(core.ref && core.data && core.size))
+			if (core.IsEmpty())
 			{
+				this->~Self();
+				new(this)Self(insertList, listSize);
 				return *this;
 			}
 
 			core.GrowthInsert(index, listSize);
-			TypeTrait::Copy(core.data + index, insertList.core.data, listSize);
+			TypeTrait::Copy(core.GetData() + index, insertList.core.GetData(), listSize);
 		}
 		return *this;
 	}
 
+	/// <summary>
+	/// <para>Construct the new element straight into the slot reserved by the growth, from the forwarded parameters.</para>
+	/// </summary>
+	template<typename... Parameters>
+	Self& EmplaceAppend(Parameters&&... params)
+	{
+		Allocator<Type>::ParameterConstruct(core.GrowthAppend(1), std::forward<Parameters>(params)...);
+		return *this;
+	}
+
+	template<typename... Parameters>
+	Self& EmplacePrepend(Parameters&&... params)
+	{
+		core.GrowthPrepend(1);
+		Allocator<Type>::ParameterConstruct(core.GetData(), std::forward<Parameters>(params)...);
+		return *this;
+	}
+
+	template<typename... Parameters>
+	Self& EmplaceInsert(size_t index, Parameters&&... params)
+	{
+		core.GrowthInsert(index, 1);
+		Allocator<Type>::ParameterConstruct(core.GetData() + index, std::forward<Parameters>(params)...);
+		return *this;
+	}
+
 	Self& Delete(size_t index, size_t count)
 	{
 		core.Delete(index, count);
@@ -647,12 +1539,76 @@ public:
 		return *this;
 	}
 
+	/// <summary>
+	/// <para>Make room for [newCapacity] elements, so appending up to them allocates nothing. A shared list gets its own block.</para>
+	/// </summary>
+	Self& Reserve(size_t newCapacity)
+	{
+		core.EnsureCapacity(newCapacity);
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>Give the unused capacity back, e.g. after a spike. A shared list keeps its block, which its other owners still use.</para>
+	/// </summary>
+	Self& ShrinkToFit()
+	{
+		core.ShrinkToFit();
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>Start a batch of edits, see ListEditor.</para>
+	/// </summary>
+	ListEditor<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy> BeginEdit() { return ListEditor<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>(*this); }
+
 	size_t IndexOf(const Type& findValue)const { return core.IndexOf(findValue); }
 	size_t LastIndexOf(const Type& findValue)const { return core.LastIndexOf(findValue); }
 	size_t IsExist(const Type& findValue)const { return core.IsExist(findValue); }
+	size_t Count(const Type& findValue)const { return core.Count(findValue); }
+
+	size_t IndexOfAny(const Type* findValues, size_t valueCount)const { return core.IndexOfAny(findValues, valueCount); }
+
+	template<typename... Values>
+	size_t IndexOfAny(const Type& findValue, const Values&... otherValues)const
+	{
+		const Type findValues[] = { findValue, Type(otherValues)... };
+		return core.IndexOfAny(findValues, 1 + sizeof...(Values));
+	}
+
+	/// <summary>
+	/// <para>Sort the elements in ascending order, Pod integers and floating points by radix, the others by introsort.</para>
+	/// <para>A shared list gets its own block first.</para>
+	/// </summary>
+	Self& Sort()
+	{
+		core.Detach(true);
+		core.Sort();
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>Merge the sorted [mergeList] into this sorted list, into one new block. The result is sorted, equal elements of this list first.</para>
+	/// </summary>
+	Self& MergeSorted(const Self& mergeList)
+	{
+		core.MergeSorted(mergeList.core, [](const Type& left, const Type& right) { return Core::IsLess(left, right); });
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>The same with both lists sorted by [less] rather than in ascending order.</para>
+	/// </summary>
+	template<typename Less>
+	Self& MergeSorted(const Self& mergeList, const Less& less)
+	{
+		core.MergeSorted(mergeList.core, less);
+		return *this;
+	}
 
 	bool IsShared()const { return core.IsShared(); }
 	bool IsSharingWith(const Self& other)const { return core.IsSharingWith(other.core); }
+	bool IsInline()const { return core.IsInline(); }
 
 	bool IsEmpty()const { return core.IsEmpty(); }
 	bool IsNull()const { return core.IsNull(); }
@@ -661,14 +1617,163 @@ public:
 	size_t GetSize()const { return core.size; }
 	size_t GetCount()const { return core.size; }
 	size_t GetLength()const { return core.size; }
-	size_t GetCapacity()const { return core.capacity; }
+	size_t GetCapacity()const { return core.GetCapacity(); }
+
+	const AllocPolicy& GetAllocPolicy()const { return core.GetAllocPolicy(); }
 
 	Type* GetData()
 	{
 		core.Detach(true);
-		return core.data;
+		return core.GetData();
+	}
+	const Type* GetConstData()const { return core.GetData(); }
+
+	/// <summary>
+	/// <para>The sub-lists below are slices, they share the block of this list and cost a reference count increment.</para>
+	/// <para>The first change to either side copies, through the usual detaching path.</para>
+	/// </summary>
+	Self GetRange(size_t index, size_t count)const { return Self(*this, index, count); }
+
+	Self GetLeft(size_t count)const { return GetRange(0, count < core.size ? count : core.size); }
+
+	Self GetRight(size_t count)const
+	{
+		if (count > core.size)
+			count = core.size;
+		return GetRange(core.size - count, count);
+	}
+
+	Self GetMiddle(size_t index, size_t count = -1)const
+	{
+		if (index > core.size)
+			index = core.size;
+		return GetRange(index, count < core.size - index ? count : core.size - index);
+	}
+
+	/// <summary>
+	/// <para>Keep the first or last [count] elements. A shared list only narrows its view, an unshared one deletes the rest.</para>
+	/// </summary>
+	Self& Left(size_t count)
+	{
+		if (count < core.size)
+			core.Narrow(0, count);
+		return *this;
+	}
+
+	Self& Right(size_t count)
+	{
+		if (count < core.size)
+			core.Narrow(core.size - count, count);
+		return *this;
+	}
+};
+
+/// <summary>
+/// <para>Records inserts, deletes and replacements by the indices of the list before the batch, Commit applies them all at once.</para>
+/// <para>The list is rebuilt in one sequential pass into one new block, a shared one is read in place instead of detached first.</para>
+/// <para>The list must not change between BeginEdit and Commit, the edits never committed are dropped with the editor.</para>
+/// </summary>
+template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+class ListEditor
+{
+private:
+	using Self = ListEditor<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+	using ListType = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+	using Edit = EscapistPrivate::ListEdit;
+	using EditKind = EscapistPrivate::ListEditKind;
+
+	ListType& list;
+	List<Edit> edits;
+	ListType values;
+
+	/// <summary>
+	/// <para>The elements of the edit are the last [count] ones of [values].</para>
+	/// </summary>
+	Self& Record(EditKind kind, size_t index, size_t count)
+	{
+		edits.Append(Edit{ index, count, values.GetSize() - (kind == EditKind::Delete ? 0 : count), kind });
+		return *this;
+	}
+
+public:
+	explicit ListEditor(ListType& list) :list(list), values(list.GetAllocPolicy()) {}
+
+	ListEditor(const Self&) = delete;
+	Self& operator=(const Self&) = delete;
+
+	Self& Insert(size_t index, const Type& insertValue)
+	{
+		assert(index <= list.GetSize());
+
+		values.Append(insertValue);
+		return Record(EditKind::Insert, index, 1);
+	}
+
+	Self& Insert(size_t index, Type&& insertValue)
+	{
+		assert(index <= list.GetSize());
+
+		values.Append(std::move(insertValue));
+		return Record(EditKind::Insert, index, 1);
+	}
+
+	Self& Insert(size_t index, const Type* insertData, size_t dataSize)
+	{
+		assert(index <= list.GetSize());
+
+		if (!insertData || !dataSize)
+			return *this;
+
+		values.Append(insertData, dataSize);
+		return Record(EditKind::Insert, index, dataSize);
+	}
+
+	Self& Delete(size_t index, size_t count)
+	{
+		assert(index + count <= list.GetSize());
+
+		if (!count)
+			return *this;
+
+		return Record(EditKind::Delete, index, count);
+	}
+
+	Self& Replace(size_t index, const Type& replaceValue)
+	{
+		assert(index < list.GetSize());
+
+		values.Append(replaceValue);
+		return Record(EditKind::Replace, index, 1);
+	}
+
+	Self& Replace(size_t index, Type&& replaceValue)
+	{
+		assert(index < list.GetSize());
+
+		values.Append(std::move(replaceValue));
+		return Record(EditKind::Replace, index, 1);
+	}
+
+	size_t GetEditCount()const { return edits.GetSize(); }
+
+	/// <summary>
+	/// <para>Sort the edits by index, stably so the ones at the same index keep their order, and apply them.</para>
+	/// <para>The editor is empty afterwards and may record the next batch.</para>
+	/// </summary>
+	ListType& Commit()
+	{
+		Edit* sorted = edits.GetData();
+		std::stable_sort(sorted, sorted + edits.GetSize());
+
+		list.core.ApplyEdits(sorted, edits.GetSize(), values.core);
+		edits.Empty();
+		return list;
 	}
-	const Type* GetConstData()const { return core.data; }
+};
+
 
-	// GetRange, Left, Right, GetLeft, GetRight, GetMiddle
-};
\ No newline at end of file
+/// <summary>
+/// <para>A list keeping up to 24 bytes of elements inside the object, it only allocates once it outgrows them.</para>
+/// </summary>
+template<typename Type, size_t InlineCapacity = 24 / sizeof(Type), typename AllocPolicy = MallocPolicy, typename GrowthPolicy = HalfGrowthPolicy, typename ReferencePolicy = AtomicReferencePolicy>
+using SmallList = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
\ No newline at end of file
@@ -0,0 +1,586 @@
+#pragma once
+
+#include<cassert>
+#include<cstdint>
+#include<cstdlib>
+#include<cstring>
+#include<type_traits>
+#include<utility>
+#include<sys/stat.h>
+#include<sys/types.h>
+#ifdef _WIN32
+#include<io.h>
+#else
+#include<sys/uio.h>
+#include<unistd.h>
+#endif
+#include"List.h"
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The first 64 bytes of a serialized list, the payload follows it, so it is aligned like the buffer holding it.</para>
+	/// <para>The byte order mark is written natively, a reader of the other order sees it swapped and swaps everything back.</para>
+	/// </summary>
+	struct SerializedListHeader
+	{
+		static constexpr uint32_t MagicValue = 0x5245534C; // "LSER"
+		static constexpr uint16_t CurrentVersion = 1;
+		static constexpr uint16_t ByteOrderMark = 0x0102;
+		static constexpr uint32_t EncodedFlag = 1; // The payload went through a codec, it is not the raw elements.
+
+		uint32_t magic;
+		uint16_t version;
+		uint16_t byteOrder;
+		uint32_t flags;
+		uint32_t reserved0;
+		uint64_t elementSize;
+		uint64_t count;
+		uint64_t payloadBytes;
+		uint64_t checksum;
+		uint64_t reserved[2];
+	};
+
+	static_assert(sizeof(SerializedListHeader) == 64, "The format must not depend on the platform.");
+
+	class ByteOrder
+	{
+	public:
+		static uint16_t Swap(uint16_t value) { return (uint16_t)((value << 8) | (value >> 8)); }
+		static uint32_t Swap(uint32_t value) { return ((uint32_t)Swap((uint16_t)value) << 16) | Swap((uint16_t)(value >> 16)); }
+		static uint64_t Swap(uint64_t value) { return ((uint64_t)Swap((uint32_t)value) << 32) | Swap((uint32_t)(value >> 32)); }
+
+		static bool IsLittleEndian()
+		{
+			const uint16_t mark = 1;
+			unsigned char low;
+			::memcpy(&low, &mark, 1);
+			return low;
+		}
+
+		/// <summary>
+		/// <para>Reverse the bytes of every scalar element in place.</para>
+		/// </summary>
+		static void SwapElements(void* elements, size_t elementSize, size_t count)
+		{
+			unsigned char* bytes = (unsigned char*)elements;
+			for (size_t index = 0; index < count; ++index, bytes += elementSize)
+				for (size_t low = 0, high = elementSize - 1; low < high; ++low, --high)
+					std::swap(bytes[low], bytes[high]);
+		}
+
+		static void SwapHeader(SerializedListHeader& header)
+		{
+			header.magic = Swap(header.magic);
+			header.version = Swap(header.version);
+			header.byteOrder = Swap(header.byteOrder);
+			header.flags = Swap(header.flags);
+			header.elementSize = Swap(header.elementSize);
+			header.count = Swap(header.count);
+			header.payloadBytes = Swap(header.payloadBytes);
+			header.checksum = Swap(header.checksum);
+		}
+	};
+
+	/// <summary>
+	/// <para>A 64-bit multiply-rotate checksum over four independent lanes, so it runs at memory speed on multi-GB payloads.</para>
+	/// <para>The words are read little-endian on any machine, and [seed] folds the element count in.</para>
+	/// </summary>
+	inline uint64_t Checksum(const void* data, size_t bytes, uint64_t seed)
+	{
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+
+		struct Lane
+		{
+			static uint64_t Rotate(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+			static uint64_t Round(uint64_t lane, uint64_t word) { return Rotate(lane + word * Prime2, 31) * Prime1; }
+		};
+
+		const unsigned char* cursor = (const unsigned char*)data;
+		uint64_t lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+		uint64_t words[4];
+		bool swapWords = !ByteOrder::IsLittleEndian();
+
+		for (; bytes >= sizeof(words); bytes -= sizeof(words), cursor += sizeof(words))
+		{
+			::memcpy(words, cursor, sizeof(words));
+			for (int lane = 0; lane < 4; ++lane)
+				lanes[lane] = Lane::Round(lanes[lane], swapWords ? ByteOrder::Swap(words[lane]) : words[lane]);
+		}
+
+		uint64_t hash = Lane::Rotate(lanes[0], 1) + Lane::Rotate(lanes[1], 7) + Lane::Rotate(lanes[2], 12) + Lane::Rotate(lanes[3], 18);
+		for (; bytes; --bytes, ++cursor)
+			hash = Lane::Round(hash, *cursor);
+
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		return hash;
+	}
+
+	/// <summary>
+	/// <para>Whole transfers over a file descriptor, a single call may move less than asked, e.g. 2 GiB at most on Linux.</para>
+	/// </summary>
+	class SerializedIo
+	{
+	private:
+		static constexpr size_t MaximumTransfer = (size_t)1 << 30;
+
+	public:
+		static bool WriteAll(int file, const void* buffer, size_t bytes)
+		{
+			const char* cursor = (const char*)buffer;
+			while (bytes)
+			{
+				size_t chunk = bytes < MaximumTransfer ? bytes : MaximumTransfer;
+#ifdef _WIN32
+				long written = ::_write(file, cursor, (unsigned)chunk);
+#else
+				ssize_t written = ::write(file, cursor, chunk);
+#endif
+				if (written <= 0)
+					return false;
+
+				cursor += written;
+				bytes -= (size_t)written;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// <para>The header and the payload go out in one writev, the rest of a partial write in further calls.</para>
+		/// </summary>
+		static bool WriteAll(int file, const void* header, size_t headerBytes, const void* payload, size_t payloadBytes)
+		{
+#ifdef _WIN32
+			return WriteAll(file, header, headerBytes) && WriteAll(file, payload, payloadBytes);
+#else
+			iovec vectors[2] = { { (void*)header, headerBytes }, { (void*)payload, payloadBytes < MaximumTransfer ? payloadBytes : MaximumTransfer } };
+			ssize_t written = ::writev(file, vectors, payloadBytes ? 2 : 1);
+			if (written < (ssize_t)headerBytes)
+				return written >= 0 && WriteAll(file, (const char*)header + written, headerBytes - written) && WriteAll(file, payload, payloadBytes);
+
+			written -= headerBytes;
+			return WriteAll(file, (const char*)payload + written, payloadBytes - written);
+#endif
+		}
+
+		/// <summary>
+		/// <para>The bytes from the current position of [file] to its end, or UINT64_MAX when it has no size, as a pipe or a socket.</para>
+		/// </summary>
+		static uint64_t GetRemaining(int file)
+		{
+#ifdef _WIN32
+			struct _stat64 status;
+			__int64 position = ::_lseeki64(file, 0, SEEK_CUR);
+			if (::_fstat64(file, &status) || position < 0 || !(status.st_mode & _S_IFREG))
+				return UINT64_MAX;
+#else
+			struct stat status;
+			off_t position = ::lseek(file, 0, SEEK_CUR);
+			if (::fstat(file, &status) || position < 0 || !S_ISREG(status.st_mode))
+				return UINT64_MAX;
+#endif
+			return (uint64_t)status.st_size > (uint64_t)position ? (uint64_t)status.st_size - (uint64_t)position : 0;
+		}
+
+		static bool ReadAll(int file, void* buffer, size_t bytes)
+		{
+			char* cursor = (char*)buffer;
+			while (bytes)
+			{
+				size_t chunk = bytes < MaximumTransfer ? bytes : MaximumTransfer;
+#ifdef _WIN32
+				long read = ::_read(file, cursor, (unsigned)chunk);
+#else
+				ssize_t read = ::read(file, cursor, chunk);
+#endif
+				if (read <= 0)
+					return false;
+
+				cursor += read;
+				bytes -= (size_t)read;
+			}
+			return true;
+		}
+	};
+}
+
+/// <summary>
+/// <para>The default codec of ListSerializer, the payload is the elements themselves, for Pod types only.</para>
+/// <para>A codec for other types is a class with three static functions, the payload is their encodings one after another:</para>
+/// <para>size_t GetEncodedSize(const Type&amp; value)</para>
+/// <para>unsigned char* Encode(const Type&amp; value, unsigned char* output), returning the end of the encoding</para>
+/// <para>const unsigned char* Decode(const unsigned char* input, const unsigned char* end, Type* element), constructing the element</para>
+/// <para>in place and returning the end of its encoding, or nullptr for a corrupt input.</para>
+/// </summary>
+struct RawListCodec
+{
+};
+
+/// <summary>
+/// <para>Saves and restores lists in a versioned binary format: a 64-byte header with the element size, the count,</para>
+/// <para>the byte order and a checksum of the payload, then the payload.</para>
+/// <para>A Pod list is written by one writev straight from its elements and read straight into the new list's elements.</para>
+/// <para>A buffer holding a whole serialized list can be adopted, becoming the storage of the list without any copy.</para>
+/// <para>Every function reports a failure by returning false and then leaves the list unchanged.</para>
+/// </summary>
+class ListSerializer
+{
+private:
+	using Header = EscapistPrivate::SerializedListHeader;
+
+	/// <summary>
+	/// <para>What a header may not make us allocate ahead of the data: the bytes read at a time from a file without a size,</para>
+	/// <para>and the elements decoded at a time, their count is only trusted as far as they decode.</para>
+	/// </summary>
+	static constexpr size_t ReadChunk = (size_t)64 << 20;
+	static constexpr size_t DecodeChunk = 64 * 1024;
+
+	template<typename Codec>
+	static constexpr bool IsRaw = std::is_same_v<Codec, RawListCodec>;
+
+	/// <summary>
+	/// <para>Only scalars can be brought to the other byte order, a struct would need to know its fields.</para>
+	/// </summary>
+	template<typename Type>
+	static constexpr bool IsSwappable = std::is_arithmetic_v<Type> || std::is_enum_v<Type>;
+
+	template<typename Codec, typename Type>
+	static Header MakeHeader(size_t count, size_t payloadBytes, uint64_t checksum)
+	{
+		Header header = {};
+		header.magic = Header::MagicValue;
+		header.version = Header::CurrentVersion;
+		header.byteOrder = Header::ByteOrderMark;
+		header.flags = IsRaw<Codec> ? 0 : Header::EncodedFlag;
+		header.elementSize = sizeof(Type);
+		header.count = count;
+		header.payloadBytes = payloadBytes;
+		header.checksum = checksum;
+		return header;
+	}
+
+	/// <summary>
+	/// <para>Bring a header of the other byte order back to ours, and check it describes a payload of [Type] through [Codec].</para>
+	/// </summary>
+	template<typename Codec, typename Type>
+	static bool CheckHeader(Header& header, bool& swapped)
+	{
+		swapped = header.magic == EscapistPrivate::ByteOrder::Swap(Header::MagicValue);
+		if (swapped)
+			EscapistPrivate::ByteOrder::SwapHeader(header);
+
+		if (header.magic != Header::MagicValue || header.version != Header::CurrentVersion || header.byteOrder != Header::ByteOrderMark)
+			return false;
+
+		if (IsRaw<Codec>)
+			return !(header.flags & Header::EncodedFlag) && header.elementSize == sizeof(Type) &&
+			header.payloadBytes / sizeof(Type) == header.count && header.payloadBytes % sizeof(Type) == 0 &&
+			(!swapped || IsSwappable<Type>);
+		else
+			return (header.flags & Header::EncodedFlag) && header.elementSize == sizeof(Type);
+	}
+
+	/// <summary>
+	/// <para>Decode [header.count] elements into a new list, which replaces [list] only if every one of them decoded.</para>
+	/// <para>The list grows by DecodeChunk elements at a time, so a corrupt count fails at the end of the payload, not in the allocation.</para>
+	/// </summary>
+	template<typename Codec, typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static bool Decode(const unsigned char* payload, const Header& header, List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list)
+	{
+		using ListType = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+
+		ListType result(list.GetAllocPolicy());
+		const unsigned char* cursor = payload;
+		const unsigned char* end = payload + header.payloadBytes;
+
+		for (uint64_t decoded = 0; decoded < header.count;)
+		{
+			size_t chunk = header.count - decoded < DecodeChunk ? (size_t)(header.count - decoded) : DecodeChunk;
+			Type* elements = result.core.GrowthAppend(chunk);
+
+			size_t index = 0;
+			for (; index < chunk; ++index)
+			{
+				cursor = Codec::Decode(cursor, end, elements + index);
+				if (!cursor)
+					break;
+			}
+
+			if (index < chunk)
+			{
+				result.core.size -= chunk - index; // Only the decoded elements are destroyed.
+				return false;
+			}
+
+			decoded += chunk;
+		}
+
+		list = std::move(result);
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Read the [header.count] raw elements of [file] into a new list. Those of a file holding [remaining] bytes are read</para>
+	/// <para>straight into a block of their size, those of a stream into a list grown by ReadChunk, it may end before its header says.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static bool ReadRaw(int file, const Header& header, uint64_t remaining, List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& result)
+	{
+		if (remaining != UINT64_MAX)
+		{
+			result.core.InitializeCore((size_t)header.count);
+			return EscapistPrivate::SerializedIo::ReadAll(file, result.core.GetData(), (size_t)header.payloadBytes);
+		}
+
+		constexpr size_t ChunkElements = ReadChunk / sizeof(Type) ? ReadChunk / sizeof(Type) : 1;
+		for (uint64_t loaded = 0; loaded < header.count;)
+		{
+			size_t chunk = header.count - loaded < ChunkElements ? (size_t)(header.count - loaded) : ChunkElements;
+			if (!EscapistPrivate::SerializedIo::ReadAll(file, result.core.GrowthAppend(chunk), chunk * sizeof(Type)))
+				return false;
+
+			loaded += chunk;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Read the [payloadBytes] of an encoded payload from [file] into a buffer of ::malloc, or nullptr for a short file</para>
+	/// <para>or a failed allocation. A stream grows the buffer as the bytes arrive, as ReadRaw does.</para>
+	/// </summary>
+	static unsigned char* ReadPayload(int file, size_t payloadBytes, uint64_t remaining)
+	{
+		size_t capacity = remaining == UINT64_MAX && payloadBytes > ReadChunk ? ReadChunk : payloadBytes;
+		unsigned char* payload = (unsigned char*)::malloc(capacity ? capacity : 1);
+
+		for (size_t loaded = 0; payload;)
+		{
+			if (!EscapistPrivate::SerializedIo::ReadAll(file, payload + loaded, capacity - loaded))
+				break;
+
+			loaded = capacity;
+			if (loaded == payloadBytes)
+				return payload;
+
+			capacity = payloadBytes - capacity < capacity ? payloadBytes : capacity * 2;
+			unsigned char* grown = (unsigned char*)::realloc(payload, capacity);
+			if (!grown)
+				break;
+			payload = grown;
+		}
+
+		::free(payload);
+		return nullptr;
+	}
+
+	/// <summary>
+	/// <para>Read or copy a raw payload from [payload] into a new list.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static void CopyRaw(const void* payload, const Header& header, bool swapped, List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list)
+	{
+		using ListType = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+
+		ListType result(list.GetAllocPolicy());
+		if (header.count)
+		{
+			result.core.InitializeCore((size_t)header.count);
+			::memcpy((void*)result.core.GetData(), payload, (size_t)header.payloadBytes);
+
+			if (swapped)
+				EscapistPrivate::ByteOrder::SwapElements(result.core.GetData(), sizeof(Type), (size_t)header.count);
+		}
+		list = std::move(result);
+	}
+
+public:
+	/// <summary>
+	/// <para>The bytes Save writes for a Pod list, or a buffer needs to hold it.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static size_t GetSerializedSize(const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list)
+	{
+		return sizeof(Header) + list.GetSize() * sizeof(Type);
+	}
+
+	/// <summary>
+	/// <para>Write [list] to [file] at its current position. Pod elements go out as they are, the others through [Codec].</para>
+	/// </summary>
+	template<typename Codec = RawListCodec, typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static bool Save(int file, const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list)
+	{
+		const Type* elements = list.GetConstData();
+		size_t count = list.GetSize();
+
+		if constexpr (IsRaw<Codec>)
+		{
+			static_assert(TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod, "Only Pod elements are saved raw, the others need a codec.");
+
+			size_t payloadBytes = count * sizeof(Type);
+			Header header = MakeHeader<Codec, Type>(count, payloadBytes, EscapistPrivate::Checksum(elements, payloadBytes, count));
+			return EscapistPrivate::SerializedIo::WriteAll(file, &header, sizeof(header), elements, payloadBytes);
+		}
+		else
+		{
+			size_t payloadBytes = 0;
+			for (size_t index = 0; index < count; ++index)
+				payloadBytes += Codec::GetEncodedSize(elements[index]);
+
+			unsigned char* payload = (unsigned char*)::malloc(payloadBytes ? payloadBytes : 1);
+			if (!payload)
+				return false;
+
+			unsigned char* cursor = payload;
+			for (size_t index = 0; index < count; ++index)
+				cursor = Codec::Encode(elements[index], cursor);
+			assert(cursor == payload + payloadBytes);
+
+			Header header = MakeHeader<Codec, Type>(count, payloadBytes, EscapistPrivate::Checksum(payload, payloadBytes, count));
+			bool written = EscapistPrivate::SerializedIo::WriteAll(file, &header, sizeof(header), payload, payloadBytes);
+
+			::free(payload);
+			return written;
+		}
+	}
+
+	/// <summary>
+	/// <para>Read a list from [file] at its current position, a Pod payload is read straight into the elements of the new list.</para>
+	/// <para>[verify] checks the payload against the checksum, one more pass over it.</para>
+	/// <para>A header promising more than the rest of the file fails before anything is allocated for it.</para>
+	/// </summary>
+	template<typename Codec = RawListCodec, typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static bool Load(int file, List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, bool verify = true)
+	{
+		using ListType = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+
+		Header header;
+		bool swapped;
+		if (!EscapistPrivate::SerializedIo::ReadAll(file, &header, sizeof(header)) || !CheckHeader<Codec, Type>(header, swapped))
+			return false;
+
+		uint64_t remaining = EscapistPrivate::SerializedIo::GetRemaining(file);
+		if (header.payloadBytes > remaining || header.payloadBytes > SIZE_MAX)
+			return false;
+
+		if constexpr (IsRaw<Codec>)
+		{
+			static_assert(TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod, "Only Pod elements are loaded raw, the others need a codec.");
+
+			ListType result(list.GetAllocPolicy());
+			if (header.count)
+			{
+				if (!ReadRaw(file, header, remaining, result))
+					return false;
+
+				Type* elements = result.core.GetData();
+				if (verify && EscapistPrivate::Checksum(elements, (size_t)header.payloadBytes, header.count) != header.checksum)
+					return false;
+
+				if (swapped)
+					EscapistPrivate::ByteOrder::SwapElements(elements, sizeof(Type), (size_t)header.count);
+			}
+			list = std::move(result);
+			return true;
+		}
+		else
+		{
+			unsigned char* payload = ReadPayload(file, (size_t)header.payloadBytes, remaining);
+			if (!payload)
+				return false;
+
+			bool loaded = (!verify || EscapistPrivate::Checksum(payload, (size_t)header.payloadBytes, header.count) == header.checksum) &&
+				Decode<Codec>(payload, header, list);
+
+			::free(payload);
+			return loaded;
+		}
+	}
+
+	/// <summary>
+	/// <para>Read a list from the [bytes] of [buffer], which stays the caller's. A Pod payload is copied by one memcpy.</para>
+	/// </summary>
+	template<typename Codec = RawListCodec, typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static bool Load(const void* buffer, size_t bytes, List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, bool verify = true)
+	{
+		Header header;
+		bool swapped;
+		if (bytes < sizeof(header))
+			return false;
+
+		::memcpy(&header, buffer, sizeof(header));
+		if (!CheckHeader<Codec, Type>(header, swapped) || header.payloadBytes > bytes - sizeof(header))
+			return false;
+
+		const unsigned char* payload = (const unsigned char*)buffer + sizeof(header);
+		if (verify && EscapistPrivate::Checksum(payload, (size_t)header.payloadBytes, header.count) != header.checksum)
+			return false;
+
+		if constexpr (IsRaw<Codec>)
+		{
+			static_assert(TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod, "Only Pod elements are loaded raw, the others need a codec.");
+
+			CopyRaw(payload, header, swapped, list);
+			return true;
+		}
+		else
+			return Decode<Codec>(payload, header, list);
+	}
+
+	/// <summary>
+	/// <para>Take over [buffer], allocated by the policy of [list] with [bytes], and read the list from it.</para>
+	/// <para>A Pod payload stays where it is and the buffer becomes the block of the list, if the element size and the</para>
+	/// <para>alignment allow: the header minus the block header of a list and [bytes] minus one must be whole elements.</para>
+	/// <para>Otherwise the payload is copied and the buffer freed, the buffer is never the caller's again, not even on failure.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	static bool Adopt(void* buffer, size_t bytes, List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, bool verify = true)
+	{
+		using ListType = List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>;
+		using Core = typename ListType::Core;
+
+		static_assert(TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod, "Only Pod elements are adopted, the others need a codec.");
+
+		constexpr size_t BlockHeaderSize = Core::CalculateBlockSize(0);
+		AllocPolicy policy = list.GetAllocPolicy();
+
+		Header header;
+		bool swapped = false;
+		bool valid = bytes >= sizeof(header);
+		if (valid)
+		{
+			::memcpy(&header, buffer, sizeof(header));
+			valid = CheckHeader<RawListCodec, Type>(header, swapped) && header.payloadBytes <= bytes - sizeof(header);
+		}
+
+		unsigned char* payload = (unsigned char*)buffer + sizeof(header);
+		if (valid && verify)
+			valid = EscapistPrivate::Checksum(payload, (size_t)header.payloadBytes, header.count) == header.checksum;
+
+		if (!valid)
+		{
+			policy.Free(buffer, bytes);
+			return false;
+		}
+
+		bool adoptable = !Core::EnableOverAlignment && header.count && sizeof(header) >= BlockHeaderSize && (sizeof(header) - BlockHeaderSize) % sizeof(Type) == 0 && (bytes - BlockHeaderSize) % sizeof(Type) == 0 &&
+			(uintptr_t)payload % alignof(Type) == 0;
+
+		if (!adoptable)
+		{
+			CopyRaw(payload, header, swapped, list);
+			policy.Free(buffer, bytes);
+			return true;
+		}
+
+		if (swapped)
+			EscapistPrivate::ByteOrder::SwapElements(payload, sizeof(Type), (size_t)header.count);
+
+		ListType result(policy);
+		result.core.AdoptBlock(buffer, (bytes - BlockHeaderSize) / sizeof(Type), (sizeof(header) - BlockHeaderSize) / sizeof(Type), (size_t)header.count);
+		list = std::move(result);
+		return true;
+	}
+};
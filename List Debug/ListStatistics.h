@@ -0,0 +1,260 @@
+#pragma once
+
+#include<atomic>
+#include<cstddef>
+#include<cstdint>
+#include<mutex>
+#include<typeinfo>
+
+// Define as 1 before including any list header to count what the lists of every element type do.
+// Left at 0, every counting call is an empty inline function and the snapshots are all zero.
+#ifndef ESCAPIST_LIST_STATISTICS
+#define ESCAPIST_LIST_STATISTICS 0
+#endif
+
+enum class ListCounter :short
+{
+	Allocations, // Blocks allocated, by the lists or by Allocator.
+	Reallocations, // Blocks resized through the policy or Allocator.
+	MovedReallocations, // Resizes that could not stay in place, the elements moved to another address.
+	Detaches, // Copies of a shared block, made by the first change of one of its owners.
+	Shares, // Blocks shared for the first time, which records the range of their elements.
+	CopiedBytes, // Elements copied inside the lists, by detaches and slices.
+	MovedBytes, // Elements moved inside the lists, by growth, insertion and deletion.
+	Count
+};
+
+/// <summary>
+/// <para>The counters of one element type, summed over every thread, and the largest capacity any of its lists reached.</para>
+/// </summary>
+struct ListStatisticsSnapshot
+{
+	const char* typeName; // From typeid, so it is mangled on some compilers.
+	uint64_t counters[(size_t)ListCounter::Count];
+	uint64_t peakCapacity;
+
+	uint64_t Get(ListCounter counter)const { return counters[(size_t)counter]; }
+};
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The counters of one thread for one element type. Only that thread writes them, so a relaxed load and store</para>
+	/// <para>is enough and no cache line bounces between threads. A cell outlives its thread, its counts stay in the sums,</para>
+	/// <para>and the next thread to start counting takes it over with them, so there are never more cells than threads at once.</para>
+	/// </summary>
+	struct ListCounterCell
+	{
+		std::atomic<uint64_t> counters[(size_t)ListCounter::Count];
+		std::atomic<uint64_t> peakCapacity;
+		ListCounterCell* next;
+		ListCounterCell* nextFree;
+	};
+
+	/// <summary>
+	/// <para>The cells of every thread for one element type, the sets of all types are chained for ListStatisticsRegistry.</para>
+	/// </summary>
+	class ListCounterSet
+	{
+	private:
+		std::mutex mutex;
+		std::atomic<ListCounterCell*> cells;
+		ListCounterCell* freeCells; // Cells of the threads that exited, under the mutex.
+		ListCounterCell lateCell;
+		const char* typeName;
+		ListCounterSet* next;
+
+		static void ClearCell(ListCounterCell& cell)
+		{
+			for (std::atomic<uint64_t>& counter : cell.counters)
+				counter.store(0, std::memory_order_relaxed);
+			cell.peakCapacity.store(0, std::memory_order_relaxed);
+		}
+
+		static std::atomic<ListCounterSet*>& GetFirst()
+		{
+			static std::atomic<ListCounterSet*> first(nullptr);
+			return first;
+		}
+
+	public:
+		ListCounterSet(const char* typeName) :cells(&lateCell), freeCells(nullptr), typeName(typeName), next(GetFirst().load(std::memory_order_acquire))
+		{
+			ClearCell(lateCell);
+			lateCell.next = nullptr;
+			lateCell.nextFree = nullptr;
+
+			while (!GetFirst().compare_exchange_weak(next, this, std::memory_order_acq_rel, std::memory_order_acquire));
+		}
+
+		/// <summary>
+		/// <para>A cell for the calling thread, one left by an exited thread if any, the mutex orders its last counts before ours.</para>
+		/// </summary>
+		ListCounterCell* Register()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (ListCounterCell* cell = freeCells)
+			{
+				freeCells = cell->nextFree;
+				return cell;
+			}
+
+			ListCounterCell* cell = new ListCounterCell();
+			ClearCell(*cell);
+			cell->next = cells.load(std::memory_order_relaxed);
+			cells.store(cell, std::memory_order_release);
+			return cell;
+		}
+
+		/// <summary>
+		/// <para>Give back the cell of an exiting thread, counts are kept in it for the next thread.</para>
+		/// </summary>
+		void Release(ListCounterCell* cell)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			cell->nextFree = freeCells;
+			freeCells = cell;
+		}
+
+		/// <summary>
+		/// <para>The cell counting for threads past their thread_local destructors, the destructors of static lists say.</para>
+		/// <para>Those threads may write it at once, and may lose a count to each other.</para>
+		/// </summary>
+		ListCounterCell* GetLateCell() { return &lateCell; }
+
+		ListStatisticsSnapshot GetSnapshot()const
+		{
+			ListStatisticsSnapshot snapshot = { typeName, {}, 0 };
+			for (ListCounterCell* cell = cells.load(std::memory_order_acquire); cell; cell = cell->next)
+			{
+				for (size_t counter = 0; counter < (size_t)ListCounter::Count; ++counter)
+					snapshot.counters[counter] += cell->counters[counter].load(std::memory_order_relaxed);
+
+				uint64_t peak = cell->peakCapacity.load(std::memory_order_relaxed);
+				if (peak > snapshot.peakCapacity)
+					snapshot.peakCapacity = peak;
+			}
+			return snapshot;
+		}
+
+		/// <summary>
+		/// <para>Counts racing with the reset may survive it or be lost, the counters are for monitoring, not accounting.</para>
+		/// </summary>
+		void Reset()
+		{
+			for (ListCounterCell* cell = cells.load(std::memory_order_acquire); cell; cell = cell->next)
+				ClearCell(*cell);
+		}
+
+		static ListCounterSet* GetFirstSet() { return GetFirst().load(std::memory_order_acquire); }
+		ListCounterSet* GetNext()const { return next; }
+	};
+
+	/// <summary>
+	/// <para>Holds the cell of one thread for one element type, and gives it back to the set when the thread exits.</para>
+	/// <para>[cell] is a trivial thread_local beside it, it then points at the late cell, as it may still be read after this destructor.</para>
+	/// </summary>
+	class ListCounterLease
+	{
+	private:
+		ListCounterSet& set;
+		ListCounterCell*& cell;
+
+	public:
+		ListCounterLease(ListCounterSet& set, ListCounterCell*& cell) :set(set), cell(cell)
+		{
+			cell = set.Register();
+		}
+
+		ListCounterLease(const ListCounterLease&) = delete;
+		ListCounterLease& operator=(const ListCounterLease&) = delete;
+
+		~ListCounterLease()
+		{
+			set.Release(cell);
+			cell = set.GetLateCell();
+		}
+	};
+}
+
+/// <summary>
+/// <para>The counters of the lists of [Type], called by ListCore and Allocator, read by GetSnapshot.</para>
+/// </summary>
+template<typename Type>
+class ListStatistics
+{
+public:
+	static constexpr bool Enable = ESCAPIST_LIST_STATISTICS;
+
+private:
+	static EscapistPrivate::ListCounterSet& GetSet()
+	{
+		static EscapistPrivate::ListCounterSet set(typeid(Type).name());
+		return set;
+	}
+
+	static EscapistPrivate::ListCounterCell& GetCell()
+	{
+		thread_local EscapistPrivate::ListCounterCell* cell = nullptr;
+		if (!cell)
+			thread_local EscapistPrivate::ListCounterLease lease(GetSet(), cell);
+		return *cell;
+	}
+
+public:
+	static void Add(ListCounter counter, uint64_t value = 1)
+	{
+		if constexpr (Enable)
+		{
+			std::atomic<uint64_t>& cell = GetCell().counters[(size_t)counter];
+			cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+	}
+
+	static void AddPeakCapacity(size_t capacity)
+	{
+		if constexpr (Enable)
+		{
+			std::atomic<uint64_t>& peak = GetCell().peakCapacity;
+			if (capacity > peak.load(std::memory_order_relaxed))
+				peak.store(capacity, std::memory_order_relaxed);
+		}
+	}
+
+	static ListStatisticsSnapshot GetSnapshot()
+	{
+		if constexpr (Enable)
+			return GetSet().GetSnapshot();
+		else
+			return { "", {}, 0 };
+	}
+
+	static void Reset()
+	{
+		if constexpr (Enable)
+			GetSet().Reset();
+	}
+};
+
+/// <summary>
+/// <para>Every element type counted so far, for scraping them all into a metrics pipeline.</para>
+/// </summary>
+class ListStatisticsRegistry
+{
+public:
+	/// <summary>
+	/// <para>Call [function] with the snapshot of every element type whose lists counted anything since the start.</para>
+	/// </summary>
+	template<typename Function>
+	static void ForEach(Function function)
+	{
+		for (EscapistPrivate::ListCounterSet* set = EscapistPrivate::ListCounterSet::GetFirstSet(); set; set = set->GetNext())
+			function(set->GetSnapshot());
+	}
+
+	static void Reset()
+	{
+		for (EscapistPrivate::ListCounterSet* set = EscapistPrivate::ListCounterSet::GetFirstSet(); set; set = set->GetNext())
+			set->Reset();
+	}
+};
@@ -0,0 +1,397 @@
+#pragma once
+
+#include<cassert>
+#include<cstdint>
+#include<cstring>
+#include<utility>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#include"List.h"
+
+enum class MappedListMode :short
+{
+	ReadOnly, // One mapping of the page cache, shared by every process opening the file this way.
+	ReadWrite, // The file is created if it does not exist.
+	Create // The file is created or truncated.
+};
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The first 64 bytes of a mapped list file, the elements follow it. The reserved words are written as zero.</para>
+	/// </summary>
+	struct MappedListHeader
+	{
+		static constexpr uint32_t MagicValue = 0x5453494C; // "LIST"
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint64_t elementSize;
+		uint64_t size;
+		uint64_t reserved[5];
+	};
+
+	static_assert(sizeof(MappedListHeader) == 64, "The file layout must not depend on the platform.");
+}
+
+/// <summary>
+/// <para>A list of Pod elements living in a memory-mapped file, so a large dataset survives the process without being rebuilt.</para>
+/// <para>Opening maps the file and checks its header, O(1), the pages are faulted in when the elements are touched.</para>
+/// <para>Growth extends the file with ftruncate and the mapping with mremap, Flush writes the dirty pages back with msync.</para>
+/// <para>Failures of the file system are reported by the return values rather than asserted, every change returns false if it failed,</para>
+/// <para>leaving the elements, the file and the mapping as they were. Delete and Empty never touch the file, they always succeed.</para>
+/// </summary>
+template<typename Type>
+class MappedList
+{
+private:
+	using Self = MappedList<Type>;
+	using Header = EscapistPrivate::MappedListHeader;
+
+	static_assert(TypeTraitPatternDefiner<Type>::Pattern == TypeTraitPattern::Pod, "Only Pod elements can live in a file.");
+	static_assert(alignof(Type) <= sizeof(Header), "The elements are aligned by the header only.");
+
+	int file;
+	Header* header;
+	size_t mappedBytes;
+	size_t capacity;
+	bool readOnly;
+
+	static size_t GetPageSize()
+	{
+		static const size_t pageSize = (size_t)::sysconf(_SC_PAGESIZE);
+		return pageSize;
+	}
+
+	/// <summary>
+	/// <para>The file size holding [elementCapacity] elements, in whole pages, the tail of the last page becomes capacity too.</para>
+	/// </summary>
+	static size_t CalculateFileSize(size_t elementCapacity)
+	{
+		size_t pageSize = GetPageSize();
+		return (sizeof(Header) + elementCapacity * sizeof(Type) + pageSize - 1) / pageSize * pageSize;
+	}
+
+	void SetMapping(void* mapping, size_t bytes)
+	{
+		header = (Header*)mapping;
+		mappedBytes = bytes;
+		capacity = (bytes - sizeof(Header)) / sizeof(Type);
+	}
+
+	bool Map(size_t bytes)
+	{
+		void* mapping = ::mmap(nullptr, bytes, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		if (mapping == MAP_FAILED)
+			return false;
+
+		SetMapping(mapping, bytes);
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Resize the mapping alone, Linux moves it with mremap, elsewhere a new mapping replaces it.</para>
+	/// <para>Returns false and keeps the old mapping if the system could not.</para>
+	/// </summary>
+	bool MoveMapping(size_t newBytes)
+	{
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+		void* mapping = ::mremap((void*)header, mappedBytes, newBytes, MREMAP_MAYMOVE);
+#else
+		void* mapping = ::mmap(nullptr, newBytes, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		if (mapping != MAP_FAILED)
+			::munmap((void*)header, mappedBytes);
+#endif
+		if (mapping == MAP_FAILED)
+			return false;
+
+		SetMapping(mapping, newBytes);
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Resize the file and its mapping. The mapping never outgrows the file, its tail would raise SIGBUS when touched,</para>
+	/// <para>so the file grows before the mapping and shrinks after it. On failure both are left at their old size.</para>
+	/// </summary>
+	bool Remap(size_t newBytes)
+	{
+		size_t oldBytes = mappedBytes;
+		if (newBytes > oldBytes)
+		{
+			if (::ftruncate(file, (off_t)newBytes))
+				return false;
+			if (MoveMapping(newBytes))
+				return true;
+
+			// Give the space back. Should that fail too, the file is only longer than the mapping, which is harmless.
+			int restored = ::ftruncate(file, (off_t)oldBytes);
+			(void)restored;
+			return false;
+		}
+
+		if (!MoveMapping(newBytes))
+			return false;
+		if (!::ftruncate(file, (off_t)newBytes))
+			return true;
+
+		// The file kept its old size, map all of it again. Should that fail too, the shorter mapping is still within the file.
+		MoveMapping(oldBytes);
+		return false;
+	}
+
+	/// <summary>
+	/// <para>Make room for [newCapacity] elements, by half of the capacity at least, so appending stays amortized O(1).</para>
+	/// </summary>
+	bool EnsureCapacity(size_t newCapacity)
+	{
+		if (newCapacity <= capacity)
+			return true;
+
+		size_t grownCapacity = capacity + capacity / 2;
+		return Remap(CalculateFileSize(grownCapacity > newCapacity ? grownCapacity : newCapacity));
+	}
+
+	Type* GetElements()const { return (Type*)(header + 1); }
+
+	bool IsMapping(const Type* pointer)const { return header && (const char*)pointer >= (const char*)header && (const char*)pointer < (const char*)header + mappedBytes; }
+
+	/// <summary>
+	/// <para>Close what is open so far and report the failure.</para>
+	/// </summary>
+	bool FailOpen()
+	{
+		Close();
+		return false;
+	}
+
+	void ResetMapping()
+	{
+		file = -1;
+		header = nullptr;
+		mappedBytes = 0;
+		capacity = 0;
+		readOnly = true;
+	}
+
+public:
+	MappedList()
+	{
+		ResetMapping();
+	}
+
+	MappedList(const char* path, MappedListMode mode = MappedListMode::ReadWrite)
+	{
+		ResetMapping();
+		Open(path, mode);
+	}
+
+	MappedList(const Self&) = delete;
+	Self& operator=(const Self&) = delete;
+
+	MappedList(Self&& other) noexcept
+		:file(other.file), header(other.header), mappedBytes(other.mappedBytes), capacity(other.capacity), readOnly(other.readOnly)
+	{
+		other.ResetMapping();
+	}
+
+	Self& operator=(Self&& other) noexcept
+	{
+		if (this != &other)
+		{
+			this->~Self();
+			new(this)Self(std::move(other));
+		}
+		return *this;
+	}
+
+	~MappedList()
+	{
+		Close();
+	}
+
+	/// <summary>
+	/// <para>Map the file at [path], a new or empty file gets a header and one page of capacity.</para>
+	/// <para>Returns false if the file cannot be opened or mapped, or holds another element size or version.</para>
+	/// </summary>
+	bool Open(const char* path, MappedListMode mode = MappedListMode::ReadWrite)
+	{
+		Close();
+
+		readOnly = mode == MappedListMode::ReadOnly;
+		int flags = readOnly ? O_RDONLY : O_RDWR | O_CREAT | (mode == MappedListMode::Create ? O_TRUNC : 0);
+
+		file = ::open(path, flags, 0644);
+		if (file < 0)
+			return FailOpen();
+
+		struct stat status;
+		if (::fstat(file, &status))
+			return FailOpen();
+
+		size_t fileSize = (size_t)status.st_size;
+		if (!fileSize && !readOnly)
+		{
+			fileSize = CalculateFileSize(0);
+			if (::ftruncate(file, (off_t)fileSize) || !Map(fileSize))
+				return FailOpen();
+
+			header->magic = Header::MagicValue;
+			header->version = Header::CurrentVersion;
+			header->elementSize = sizeof(Type);
+			header->size = 0;
+			::memset(header->reserved, 0, sizeof(header->reserved));
+			return true;
+		}
+
+		if (fileSize < sizeof(Header) || !Map(fileSize))
+			return FailOpen();
+
+		if (header->magic != Header::MagicValue || header->version != Header::CurrentVersion ||
+			header->elementSize != sizeof(Type) || header->size > capacity)
+			return FailOpen();
+
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Unmap and close the file, the kernel writes the dirty pages back even without Flush.</para>
+	/// </summary>
+	void Close()
+	{
+		if (header)
+			::munmap((void*)header, mappedBytes);
+		if (file >= 0)
+			::close(file);
+
+		ResetMapping();
+	}
+
+	/// <summary>
+	/// <para>Write the dirty pages back to the file and wait for them, returns false if the system could not.</para>
+	/// </summary>
+	bool Flush()
+	{
+		return header && (readOnly || !::msync((void*)header, mappedBytes, MS_SYNC));
+	}
+
+	/// <summary>
+	/// <para>Returns false, appending nothing, if the file could not grow, e.g. the disk is full or the file size is limited.</para>
+	/// </summary>
+	bool Append(const Type& appendValue)
+	{
+		assert(IsOpen() && !readOnly);
+
+		Type value = appendValue; // It may be one of ours, which the remapping would move.
+		if (!EnsureCapacity(header->size + 1))
+			return false;
+
+		GetElements()[header->size++] = value;
+		return true;
+	}
+
+	bool Append(const Type* appendData, size_t dataSize)
+	{
+		assert(IsOpen() && !readOnly);
+
+		if (!appendData || !dataSize)
+			return true;
+
+		// Our own elements are found again by their index after the remapping.
+		size_t ownIndex = IsMapping(appendData) ? (size_t)(appendData - GetElements()) : (size_t)-1;
+
+		if (!EnsureCapacity(header->size + dataSize))
+			return false;
+
+		if (ownIndex != (size_t)-1)
+			appendData = GetElements() + ownIndex;
+
+		::memcpy((void*)(GetElements() + header->size), (const void*)appendData, dataSize * sizeof(Type));
+		header->size += dataSize;
+		return true;
+	}
+
+	template<typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	bool Append(const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& appendList)
+	{
+		return Append(appendList.GetConstData(), appendList.GetSize());
+	}
+
+	bool Delete(size_t index, size_t count)
+	{
+		assert(IsOpen() && !readOnly && index + count <= header->size);
+
+		Type* elements = GetElements();
+		::memmove((void*)(elements + index), (const void*)(elements + index + count), (header->size - index - count) * sizeof(Type));
+		header->size -= count;
+		return true;
+	}
+
+	bool Empty()
+	{
+		assert(IsOpen() && !readOnly);
+
+		header->size = 0;
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Replace the elements by the ones of an ordinary list. Returns false, keeping the old elements, if the file could not grow.</para>
+	/// </summary>
+	template<typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy>
+	bool Assign(const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& assignList)
+	{
+		assert(IsOpen() && !readOnly);
+
+		if (!EnsureCapacity(assignList.GetSize()))
+			return false;
+
+		Empty();
+		return Append(assignList);
+	}
+
+	bool Reserve(size_t newCapacity)
+	{
+		assert(IsOpen() && !readOnly);
+
+		return newCapacity <= capacity || Remap(CalculateFileSize(newCapacity));
+	}
+
+	/// <summary>
+	/// <para>Truncate the file to the pages its elements need.</para>
+	/// </summary>
+	bool ShrinkToFit()
+	{
+		assert(IsOpen() && !readOnly);
+
+		size_t fileSize = CalculateFileSize(header->size);
+		return fileSize >= mappedBytes || Remap(fileSize);
+	}
+
+	/// <summary>
+	/// <para>Copy the elements to an ordinary list, which no longer depends on the file.</para>
+	/// </summary>
+	template<typename AllocPolicy = MallocPolicy>
+	List<Type, AllocPolicy> ToList(const AllocPolicy& policy = AllocPolicy())const
+	{
+		return List<Type, AllocPolicy>(GetConstData(), GetSize(), policy);
+	}
+
+	bool IsOpen()const { return header; }
+	bool IsReadOnly()const { return readOnly; }
+	bool IsEmpty()const { return !GetSize(); }
+
+	size_t GetSize()const { return header ? (size_t)header->size : 0; }
+	size_t GetCount()const { return GetSize(); }
+	size_t GetLength()const { return GetSize(); }
+	size_t GetCapacity()const { return capacity; }
+
+	Type* GetData()
+	{
+		assert(!readOnly);
+		return header ? GetElements() : nullptr;
+	}
+	const Type* GetConstData()const { return header ? GetElements() : nullptr; }
+};
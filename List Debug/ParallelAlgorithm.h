@@ -0,0 +1,389 @@
+#pragma once
+
+#include<algorithm>
+#include<cassert>
+#include<cstddef>
+#include<cstdint>
+#include<functional>
+#include<type_traits>
+#include<vector>
+#include"List.h"
+#include"ThreadPool.h"
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The chunks of a parallel loop over [size] elements at [data]. Each boundary is moved up to the next cache line,</para>
+	/// <para>so no two threads write the same line. Elements that do not divide a line keep the plain boundaries.</para>
+	/// </summary>
+	template<typename Type>
+	class ChunkPlan
+	{
+	private:
+		static constexpr size_t CacheLine = 64;
+
+		const Type* data;
+		size_t size;
+		size_t chunkCount;
+
+	public:
+		ChunkPlan(const Type* data, size_t size, size_t chunkCount) :data(data), size(size), chunkCount(chunkCount) {}
+
+		size_t GetCount()const { return chunkCount; }
+
+		size_t GetBegin(size_t chunk)const
+		{
+			if (!chunk)
+				return 0;
+			if (chunk >= chunkCount)
+				return size;
+
+			size_t index = size / chunkCount * chunk + size % chunkCount * chunk / chunkCount;
+			if constexpr (CacheLine % sizeof(Type) == 0)
+			{
+				size_t misalignment = (size_t)((uintptr_t)(data + index) % CacheLine);
+				if (misalignment)
+					index += (CacheLine - misalignment) / sizeof(Type);
+			}
+			return index < size ? index : size;
+		}
+
+		size_t GetEnd(size_t chunk)const { return GetBegin(chunk + 1); }
+	};
+}
+
+/// <summary>
+/// <para>Parallel loops over the elements of a List, on a work-stealing ThreadPool, the default one unless another is given.</para>
+/// <para>The read-only ones take the elements by GetConstData, so a shared list is never detached for them.</para>
+/// <para>Below SequentialCutoff elements, or with a pool of one thread, they run sequentially on the calling thread.</para>
+/// <para>The functions are called concurrently, on elements of different chunks, and must not depend on their order.</para>
+/// </summary>
+class ParallelAlgorithm
+{
+private:
+	static constexpr size_t MinimumChunk = 4096; // A chunk must outweigh the cost of queueing and stealing it.
+	static constexpr size_t ChunksPerThread = 4; // Spare chunks for the threads that finish early to steal.
+
+	static bool IsSequential(size_t size, ThreadPool& pool) { return size < SequentialCutoff || pool.GetThreadCount() == 1; }
+
+	template<typename Type>
+	static EscapistPrivate::ChunkPlan<Type> PlanChunks(const Type* data, size_t size, ThreadPool& pool)
+	{
+		size_t chunkCount = pool.GetThreadCount() * ChunksPerThread;
+		if (chunkCount > size / MinimumChunk)
+			chunkCount = size / MinimumChunk ? size / MinimumChunk : 1;
+		return EscapistPrivate::ChunkPlan<Type>(data, size, chunkCount);
+	}
+
+	/// <summary>
+	/// <para>Call [body](begin, end, chunk) for every chunk of [plan] on the pool.</para>
+	/// </summary>
+	template<typename Type, typename Body>
+	static void RunChunks(const EscapistPrivate::ChunkPlan<Type>& plan, ThreadPool& pool, const Body& body)
+	{
+		pool.Run(plan.GetCount(), [&](size_t chunk) { body(plan.GetBegin(chunk), plan.GetEnd(chunk), chunk); });
+	}
+
+	/// <summary>
+	/// <para>Move [count] elements from [source] to the uninitialized [dest] on the pool, the sources are left uninitialized.</para>
+	/// </summary>
+	template<typename Type>
+	static void RelocateAll(Type* dest, Type* source, size_t count, ThreadPool& pool)
+	{
+		using TypeTrait = typename TypeTraitPatternSelector<Type>::TypeTrait;
+
+		RunChunks(PlanChunks(dest, count, pool), pool, [&](size_t begin, size_t end, size_t)
+			{
+				TypeTrait::Move(dest + begin, source + begin, end - begin);
+			});
+	}
+
+	/// <summary>
+	/// <para>The number of elements of [a] among the first [rank] of the stable merge of [a] and [b], found by binary search.</para>
+	/// </summary>
+	template<typename Type, typename Compare>
+	static size_t CoRank(size_t rank, const Type* a, size_t aSize, const Type* b, size_t bSize, const Compare& compare)
+	{
+		size_t low = rank > bSize ? rank - bSize : 0;
+		size_t high = rank < aSize ? rank : aSize;
+		while (low < high)
+		{
+			size_t index = low + (high - low) / 2;
+			size_t other = rank - index;
+			if (other && index < aSize && !compare(b[other - 1], a[index]))
+				low = index + 1;
+			else
+				high = index;
+		}
+		return low;
+	}
+
+	/// <summary>
+	/// <para>The first element of the output of piece [piece] of [pieceCount], each piece an equal share of [total].</para>
+	/// </summary>
+	static size_t GetPieceBegin(size_t total, size_t piece, size_t pieceCount)
+	{
+		return piece < pieceCount ? total / pieceCount * piece + total % pieceCount * piece / pieceCount : total;
+	}
+
+	/// <summary>
+	/// <para>Merge [a][aIndex, aEnd) and [b][bIndex, bEnd) into the uninitialized [dest], moving the elements out of them. Ties take [a] first.</para>
+	/// </summary>
+	template<typename Type, typename Compare>
+	static void MergePiece(Type* a, size_t aIndex, size_t aEnd, Type* b, size_t bIndex, size_t bEnd, Type* dest, const Compare& compare)
+	{
+		using TypeTrait = typename TypeTraitPatternSelector<Type>::TypeTrait;
+
+		while (aIndex < aEnd && bIndex < bEnd)
+		{
+			if (compare(b[bIndex], a[aIndex]))
+				TypeTrait::Move(dest++, b + bIndex++, 1);
+			else
+				TypeTrait::Move(dest++, a + aIndex++, 1);
+		}
+		TypeTrait::Move(dest, a + aIndex, aEnd - aIndex);
+		TypeTrait::Move(dest + (aEnd - aIndex), b + bIndex, bEnd - bIndex);
+	}
+
+	/// <summary>
+	/// <para>Sort a power of two of runs in parallel, then merge them pairwise, between the list and a buffer, every merge split across the threads.</para>
+	/// </summary>
+	template<bool Stable, typename Type, typename Compare>
+	static void SortRuns(Type* data, size_t size, const Compare& compare, ThreadPool& pool)
+	{
+		size_t threadCount = pool.GetThreadCount();
+		size_t runCount = 1;
+		while (runCount < threadCount && runCount * 2 <= size / MinimumChunk)
+			runCount *= 2;
+
+		if (runCount == 1)
+		{
+			if constexpr (Stable)
+				std::stable_sort(data, data + size, compare);
+			else
+				std::sort(data, data + size, compare);
+			return;
+		}
+
+		EscapistPrivate::ChunkPlan<Type> runs(data, size, runCount);
+		RunChunks(runs, pool, [&](size_t begin, size_t end, size_t)
+			{
+				if constexpr (Stable)
+					std::stable_sort(data + begin, data + end, compare);
+				else
+					std::sort(data + begin, data + end, compare);
+			});
+
+		Type* buffer = Allocator<Type>::TypedAllocate(size);
+		Type* from = data;
+		Type* to = buffer;
+
+		// Every merge is cut into pieces of equal output, so the pieces of one merge run in parallel.
+		// The cuts are all searched before any piece moves an element out of the runs they search.
+		std::vector<size_t> cuts;
+
+		for (size_t width = 1; width < runCount; width *= 2)
+		{
+			size_t pairCount = runCount / (width * 2);
+			size_t pieceCount = (threadCount * ChunksPerThread + pairCount - 1) / pairCount;
+			cuts.resize(pairCount * (pieceCount + 1));
+
+			auto getRuns = [&](size_t pair, size_t& begin, size_t& middle, size_t& end)
+				{
+					begin = runs.GetBegin(pair * width * 2);
+					middle = runs.GetBegin(pair * width * 2 + width);
+					end = runs.GetBegin(pair * width * 2 + width * 2);
+				};
+
+			pool.Run(cuts.size(), [&](size_t cut)
+				{
+					size_t begin, middle, end;
+					getRuns(cut / (pieceCount + 1), begin, middle, end);
+
+					size_t rank = GetPieceBegin(end - begin, cut % (pieceCount + 1), pieceCount);
+					cuts[cut] = CoRank(rank, from + begin, middle - begin, from + middle, end - middle, compare);
+				});
+
+			pool.Run(pairCount * pieceCount, [&](size_t task)
+				{
+					size_t pair = task / pieceCount;
+					size_t piece = task % pieceCount;
+					size_t begin, middle, end;
+					getRuns(pair, begin, middle, end);
+
+					size_t first = GetPieceBegin(end - begin, piece, pieceCount);
+					size_t last = GetPieceBegin(end - begin, piece + 1, pieceCount);
+					size_t aIndex = cuts[pair * (pieceCount + 1) + piece];
+					size_t aEnd = cuts[pair * (pieceCount + 1) + piece + 1];
+
+					MergePiece(from + begin, aIndex, aEnd, from + middle, first - aIndex, last - aEnd, to + begin + first, compare);
+				});
+
+			std::swap(from, to);
+		}
+
+		if (from != data)
+			RelocateAll(data, from, size, pool);
+
+		Allocator<Type>::Free(buffer);
+	}
+
+public:
+	static constexpr size_t SequentialCutoff = 32768;
+
+	/// <summary>
+	/// <para>Call [function](element) for every element, read-only.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy, typename Function>
+	static void ForEach(const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, const Function& function, ThreadPool& pool = ThreadPool::GetDefault())
+	{
+		const Type* data = list.GetConstData();
+		size_t size = list.GetSize();
+
+		if (IsSequential(size, pool))
+		{
+			for (size_t index = 0; index < size; ++index)
+				function(data[index]);
+			return;
+		}
+
+		RunChunks(PlanChunks(data, size, pool), pool, [&](size_t begin, size_t end, size_t)
+			{
+				for (size_t index = begin; index < end; ++index)
+					function(data[index]);
+			});
+	}
+
+	/// <summary>
+	/// <para>A new list of [function](element) for every element, constructed in place, the source list is left as it is.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy, typename Function,
+		typename Result = std::decay_t<std::invoke_result_t<const Function&, const Type&>>>
+	static List<Result, AllocPolicy> Transform(const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, const Function& function, ThreadPool& pool = ThreadPool::GetDefault())
+	{
+		const Type* data = list.GetConstData();
+		size_t size = list.GetSize();
+
+		List<Result, AllocPolicy> result(size, list.GetAllocPolicy()); // Uninitialized, every element is constructed below.
+		Result* target = result.GetData();
+
+		if (IsSequential(size, pool))
+		{
+			for (size_t index = 0; index < size; ++index)
+				Allocator<Result>::ParameterConstruct(target + index, function(data[index]));
+			return result;
+		}
+
+		RunChunks(PlanChunks(target, size, pool), pool, [&](size_t begin, size_t end, size_t)
+			{
+				for (size_t index = begin; index < end; ++index)
+					Allocator<Result>::ParameterConstruct(target + index, function(data[index]));
+			});
+		return result;
+	}
+
+	/// <summary>
+	/// <para>Fold the elements into [initial] with [operation], which must be associative, but needs not be commutative:</para>
+	/// <para>every chunk is folded on its own, then the chunks are folded in order.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy, typename Operation>
+	static Type Reduce(const List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, Type initial, const Operation& operation, ThreadPool& pool = ThreadPool::GetDefault())
+	{
+		const Type* data = list.GetConstData();
+		size_t size = list.GetSize();
+
+		if (IsSequential(size, pool))
+		{
+			for (size_t index = 0; index < size; ++index)
+				initial = operation(initial, data[index]);
+			return initial;
+		}
+
+		EscapistPrivate::ChunkPlan<Type> plan = PlanChunks(data, size, pool);
+		List<Type> partials(plan.GetCount()); // Uninitialized, every chunk constructs its own.
+		Type* partial = partials.GetData();
+
+		RunChunks(plan, pool, [&](size_t begin, size_t end, size_t chunk)
+			{
+				assert(begin < end);
+
+				Type value = data[begin];
+				for (size_t index = begin + 1; index < end; ++index)
+					value = operation(value, data[index]);
+				Allocator<Type>::ParameterConstruct(partial + chunk, std::move(value));
+			});
+
+		for (size_t chunk = 0; chunk < plan.GetCount(); ++chunk)
+			initial = operation(initial, partial[chunk]);
+		return initial;
+	}
+
+	/// <summary>
+	/// <para>Sort the elements by [compare], the equal ones in any order. The list is detached first if it is shared.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy, typename Compare = std::less<Type>>
+	static void Sort(List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, const Compare& compare = Compare(), ThreadPool& pool = ThreadPool::GetDefault())
+	{
+		if (IsSequential(list.GetSize(), pool))
+			std::sort(list.GetData(), list.GetData() + list.GetSize(), compare);
+		else
+			SortRuns<false>(list.GetData(), list.GetSize(), compare, pool);
+	}
+
+	/// <summary>
+	/// <para>Sort the elements by [compare], the equal ones keep their order.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy, typename Compare = std::less<Type>>
+	static void StableSort(List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, const Compare& compare = Compare(), ThreadPool& pool = ThreadPool::GetDefault())
+	{
+		if (IsSequential(list.GetSize(), pool))
+			std::stable_sort(list.GetData(), list.GetData() + list.GetSize(), compare);
+		else
+			SortRuns<true>(list.GetData(), list.GetSize(), compare, pool);
+	}
+
+	/// <summary>
+	/// <para>Move the elements satisfying [predicate] before the others, both keeping their order, and return how many there are.</para>
+	/// <para>The predicate is called twice per element, to count then to place it, it must give the same answer both times.</para>
+	/// </summary>
+	template<typename Type, typename AllocPolicy, size_t InlineCapacity, typename GrowthPolicy, typename ReferencePolicy, typename Predicate>
+	static size_t Partition(List<Type, AllocPolicy, InlineCapacity, GrowthPolicy, ReferencePolicy>& list, const Predicate& predicate, ThreadPool& pool = ThreadPool::GetDefault())
+	{
+		using TypeTrait = typename TypeTraitPatternSelector<Type>::TypeTrait;
+
+		Type* data = list.GetData();
+		size_t size = list.GetSize();
+
+		if (IsSequential(size, pool))
+			return (size_t)(std::stable_partition(data, data + size, predicate) - data);
+
+		EscapistPrivate::ChunkPlan<Type> plan = PlanChunks(data, size, pool);
+		std::vector<size_t> offsets(plan.GetCount() + 1);
+
+		RunChunks(plan, pool, [&](size_t begin, size_t end, size_t chunk)
+			{
+				size_t count = 0;
+				for (size_t index = begin; index < end; ++index)
+					count += predicate(data[index]) ? 1 : 0;
+				offsets[chunk + 1] = count;
+			});
+
+		// The satisfying elements of a chunk go after the ones of the chunks before it, the others after all the satisfying ones.
+		for (size_t chunk = 0; chunk < plan.GetCount(); ++chunk)
+			offsets[chunk + 1] += offsets[chunk];
+		size_t satisfying = offsets[plan.GetCount()];
+
+		Type* buffer = Allocator<Type>::TypedAllocate(size);
+		RunChunks(plan, pool, [&](size_t begin, size_t end, size_t chunk)
+			{
+				size_t front = offsets[chunk];
+				size_t back = satisfying + begin - offsets[chunk];
+				for (size_t index = begin; index < end; ++index)
+					TypeTrait::Move(buffer + (predicate(data[index]) ? front++ : back++), data + index, 1);
+			});
+
+		RelocateAll(data, buffer, size, pool);
+		Allocator<Type>::Free(buffer);
+		return satisfying;
+	}
+};
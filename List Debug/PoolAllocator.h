@@ -0,0 +1,316 @@
+#pragma once
+
+#include<cassert>
+#include<cstddef>
+#include<cstdlib>
+#include<cstring>
+#include<mutex>
+#include"Allocator.h"
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>The size classes of the pool, four classes per power of two from 16 bytes to 64 KiB.</para>
+	/// <para>A request is rounded up to its class, so at most a quarter of a block is slack.</para>
+	/// </summary>
+	class PoolSizeClass
+	{
+	public:
+		static constexpr size_t MinimumSize = 16;
+		static constexpr size_t MaximumSize = 65536;
+		static constexpr size_t Count = 49;
+
+		static size_t GetHighestBit(size_t value)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll((unsigned long long)value);
+#else
+			size_t bit = 0;
+			while (value >>= 1)
+				++bit;
+			return bit;
+#endif
+		}
+
+		static bool IsPooled(size_t size) { return size <= MaximumSize; }
+
+		static size_t GetIndex(size_t size)
+		{
+			if (size <= MinimumSize)
+				return 0;
+
+			size_t last = size - 1;
+			size_t bit = GetHighestBit(last);
+			return (bit - 4) * 4 + ((last >> (bit - 2)) & 3) + 1;
+		}
+
+		static size_t GetSize(size_t index)
+		{
+			if (!index)
+				return MinimumSize;
+
+			size_t bit = (index - 1) / 4 + 4;
+			return (((index - 1) % 4) + 5) << (bit - 2);
+		}
+
+		/// <summary>
+		/// <para>How many blocks travel together between a thread cache and the central lists, about 64 KiB worth.</para>
+		/// </summary>
+		static size_t GetBatch(size_t index)
+		{
+			size_t batch = MaximumSize / GetSize(index);
+			return batch < 2 ? 2 : batch > 32 ? 32 : batch;
+		}
+	};
+
+	struct PoolBlock
+	{
+		PoolBlock* next;
+	};
+
+	/// <summary>
+	/// <para>The free lists shared by every thread, thread caches give their surplus here and refill from here.</para>
+	/// <para>That is how a block freed by another thread comes back to the allocating one.</para>
+	/// <para>Beyond the limit of a class, the blocks are given back to ::free.</para>
+	/// </summary>
+	class PoolCentral
+	{
+	private:
+		struct Bin
+		{
+			std::mutex mutex;
+			PoolBlock* head = nullptr;
+			size_t count = 0;
+		};
+
+		Bin bins[PoolSizeClass::Count];
+
+	public:
+		static constexpr size_t LimitBatches = 64;
+
+		static PoolCentral& Get()
+		{
+			static PoolCentral* central = new PoolCentral(); // Never destroyed, thread caches may flush into it during exit.
+			return *central;
+		}
+
+		void Push(size_t index, PoolBlock* head, size_t count)
+		{
+			size_t limit = PoolSizeClass::GetBatch(index) * LimitBatches;
+
+			{
+				Bin& bin = bins[index];
+				std::lock_guard<std::mutex> lock(bin.mutex);
+
+				while (head && bin.count < limit)
+				{
+					PoolBlock* next = head->next;
+					head->next = bin.head;
+					bin.head = head;
+					++bin.count;
+
+					head = next;
+					--count;
+				}
+			}
+
+			while (head)
+			{
+				PoolBlock* next = head->next;
+				::free((void*)head);
+				head = next;
+			}
+		}
+
+		/// <summary>
+		/// <para>Take up to [maximum] blocks as a chain, returns the number taken.</para>
+		/// </summary>
+		size_t Pop(size_t index, PoolBlock*& head, size_t maximum)
+		{
+			Bin& bin = bins[index];
+			std::lock_guard<std::mutex> lock(bin.mutex);
+
+			size_t count = 0;
+			head = nullptr;
+			for (; bin.head && count < maximum; ++count)
+			{
+				PoolBlock* block = bin.head;
+				bin.head = block->next;
+				block->next = head;
+				head = block;
+			}
+			bin.count -= count;
+			return count;
+		}
+	};
+
+	/// <summary>
+	/// <para>The per-thread free lists, the common path of Allocate and Free touches nothing else.</para>
+	/// </summary>
+	class PoolCache
+	{
+	private:
+		struct Bin
+		{
+			PoolBlock* head = nullptr;
+			size_t count = 0;
+		};
+
+		Bin bins[PoolSizeClass::Count];
+
+		// Both trivial, so they are reachable without the guard of a thread_local object, and outlive the cache itself.
+		static PoolCache*& GetCurrent()
+		{
+			thread_local PoolCache* current = nullptr;
+			return current;
+		}
+
+		static bool& IsDestroyed()
+		{
+			thread_local bool destroyed = false;
+			return destroyed;
+		}
+
+		static PoolCache* Create()
+		{
+			if (IsDestroyed())
+				return nullptr;
+
+			thread_local PoolCache cache;
+			return GetCurrent() = &cache;
+		}
+
+		void Flush(size_t index, size_t keep)
+		{
+			Bin& bin = bins[index];
+			if (bin.count <= keep)
+				return;
+
+			PoolBlock* head = bin.head;
+			PoolBlock* last = head;
+			size_t count = bin.count - keep;
+			for (size_t step = 1; step < count; ++step)
+				last = last->next;
+
+			bin.head = last->next;
+			bin.count = keep;
+			last->next = nullptr;
+
+			PoolCentral::Get().Push(index, head, count);
+		}
+
+	public:
+		~PoolCache()
+		{
+			for (size_t index = 0; index < PoolSizeClass::Count; ++index)
+				Flush(index, 0);
+
+			GetCurrent() = nullptr;
+			IsDestroyed() = true;
+		}
+
+		/// <summary>
+		/// <para>The cache of the calling thread, nullptr once the thread is exiting and the cache is gone.</para>
+		/// </summary>
+		static PoolCache* Get()
+		{
+			PoolCache* current = GetCurrent();
+			return current ? current : Create();
+		}
+
+		void* Allocate(size_t index)
+		{
+			Bin& bin = bins[index];
+			if (!bin.head)
+				bin.count = PoolCentral::Get().Pop(index, bin.head, PoolSizeClass::GetBatch(index));
+
+			if (!bin.head)
+				return MallocPolicy().Allocate(PoolSizeClass::GetSize(index));
+
+			PoolBlock* block = bin.head;
+			bin.head = block->next;
+			--bin.count;
+			return (void*)block;
+		}
+
+		void Free(void* pointer, size_t index)
+		{
+			Bin& bin = bins[index];
+
+			PoolBlock* block = (PoolBlock*)pointer;
+			block->next = bin.head;
+			bin.head = block;
+
+			size_t batch = PoolSizeClass::GetBatch(index);
+			if (++bin.count > batch * 2)
+				Flush(index, batch);
+		}
+	};
+}
+
+/// <summary>
+/// <para>A pooling policy for short-lived lists, their data blocks are served by it.</para>
+/// <para>Blocks up to 64 KiB come from per-thread size-class free lists, larger ones go straight to ::malloc.</para>
+/// <para>Any thread may free a block, surplus blocks move through the central lists back to the allocating threads.</para>
+/// </summary>
+class PoolPolicy
+{
+public:
+	void* Allocate(size_t size)
+	{
+		if (!EscapistPrivate::PoolSizeClass::IsPooled(size))
+			return MallocPolicy().Allocate(size);
+
+		size_t index = EscapistPrivate::PoolSizeClass::GetIndex(size);
+
+		EscapistPrivate::PoolCache* cache = EscapistPrivate::PoolCache::Get();
+		if (!cache)
+			return MallocPolicy().Allocate(EscapistPrivate::PoolSizeClass::GetSize(index));
+
+		return cache->Allocate(index);
+	}
+
+	void* Reallocate(void* pointer, size_t oldSize, size_t newSize)
+	{
+		bool oldPooled = EscapistPrivate::PoolSizeClass::IsPooled(oldSize);
+		bool newPooled = EscapistPrivate::PoolSizeClass::IsPooled(newSize);
+
+		if (!oldPooled && !newPooled)
+			return MallocPolicy().Reallocate(pointer, oldSize, newSize);
+
+		if (oldPooled && newPooled &&
+			EscapistPrivate::PoolSizeClass::GetIndex(oldSize) == EscapistPrivate::PoolSizeClass::GetIndex(newSize))
+			return pointer; // Still fits in the block of the same class.
+
+		void* newPointer = Allocate(newSize);
+		::memcpy(newPointer, pointer, oldSize < newSize ? oldSize : newSize);
+		Free(pointer, oldSize);
+		return newPointer;
+	}
+
+	void Free(void* pointer, size_t size)
+	{
+		if (!EscapistPrivate::PoolSizeClass::IsPooled(size))
+			return MallocPolicy().Free(pointer, size);
+
+		size_t index = EscapistPrivate::PoolSizeClass::GetIndex(size);
+
+		EscapistPrivate::PoolCache* cache = EscapistPrivate::PoolCache::Get();
+		if (!cache)
+		{
+			((EscapistPrivate::PoolBlock*)pointer)->next = nullptr;
+			EscapistPrivate::PoolCentral::Get().Push(index, (EscapistPrivate::PoolBlock*)pointer, 1);
+			return;
+		}
+
+		cache->Free(pointer, index);
+	}
+
+	size_t GetUsableSize(size_t size)const
+	{
+		if (!EscapistPrivate::PoolSizeClass::IsPooled(size))
+			return MallocPolicy().GetUsableSize(size);
+
+		return EscapistPrivate::PoolSizeClass::GetSize(EscapistPrivate::PoolSizeClass::GetIndex(size));
+	}
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<type_traits>
+
+
+namespace EscapistPrivate
+{
+	namespace Radix
+	{
+		/// <summary>
+		/// <para>Below this many elements per byte of the key, introsort wins over the passes and the scratch buffer.</para>
+		/// </summary>
+		static constexpr size_t MinimumSizePerByte = 256;
+
+		template<typename T>
+		constexpr size_t GetMinimumSize() { return MinimumSizePerByte * sizeof(T); }
+
+		template<size_t Size>
+		struct UnsignedKey;
+
+		template<> struct UnsignedKey<1> { using Key = uint8_t; };
+		template<> struct UnsignedKey<2> { using Key = uint16_t; };
+		template<> struct UnsignedKey<4> { using Key = uint32_t; };
+		template<> struct UnsignedKey<8> { using Key = uint64_t; };
+
+		template<typename T, bool = std::is_enum_v<T>>
+		struct IsSignedKey { static constexpr bool Value = std::is_signed_v<T>; };
+
+		template<typename T>
+		struct IsSignedKey<T, true> { static constexpr bool Value = std::is_signed_v<std::underlying_type_t<T>>; };
+
+		/// <summary>
+		/// <para>The unsigned key a Pod type is sorted by, whose order is the order of the values: integers and enumerations with the sign bit flipped,</para>
+		/// <para>float and double with the sign bit flipped for the positive ones and every bit for the negative ones.</para>
+		/// <para>Other Pod types, like user structs with their own operator&lt;, keep introsort.</para>
+		/// </summary>
+		template<typename T, typename = void>
+		struct RadixKey
+		{
+			static constexpr bool Enable = false;
+		};
+
+		template<typename T>
+		struct RadixKey<T, typename std::enable_if<(std::is_integral_v<T> || std::is_enum_v<T>) &&
+			(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>::type>
+		{
+			static constexpr bool Enable = true;
+			using Key = typename UnsignedKey<sizeof(T)>::Key;
+
+			static Key ToKey(const T& value)
+			{
+				Key key;
+				::memcpy(&key, &value, sizeof(Key));
+				if constexpr (IsSignedKey<T>::Value)
+					key ^= (Key)((Key)1 << (sizeof(Key) * 8 - 1));
+				return key;
+			}
+		};
+
+		template<typename T>
+		struct RadixKey<T, typename std::enable_if<std::is_same_v<T, float> || std::is_same_v<T, double>>::type>
+		{
+			static constexpr bool Enable = true;
+			using Key = typename UnsignedKey<sizeof(T)>::Key;
+
+			/// <summary>
+			/// <para>-0.0 comes right before +0.0, the NaNs after +inf or, with the sign bit, before -inf.</para>
+			/// </summary>
+			static Key ToKey(const T& value)
+			{
+				constexpr Key SignBit = (Key)1 << (sizeof(Key) * 8 - 1);
+
+				Key key;
+				::memcpy(&key, &value, sizeof(Key));
+				return key & SignBit ? (Key)~key : (Key)(key | SignBit);
+			}
+		};
+
+		/// <summary>
+		/// <para>Sort [size] elements at [data] by their keys, least significant byte first, stably, through [scratch] of the same size.</para>
+		/// <para>One read counts the bytes of all the digits at once. A digit every key shares is skipped, so small integers in a wide type</para>
+		/// <para>cost only the passes of their low bytes.</para>
+		/// </summary>
+		template<typename T>
+		void Sort(T* data, T* scratch, size_t size)
+		{
+			using Lane = RadixKey<T>;
+			using Key = typename Lane::Key;
+			static constexpr size_t PassCount = sizeof(Key);
+
+			size_t counts[PassCount][256] = {};
+			for (size_t index = 0; index < size; ++index)
+			{
+				Key key = Lane::ToKey(data[index]);
+				for (size_t pass = 0; pass < PassCount; ++pass)
+					++counts[pass][(key >> (pass * 8)) & 0xFF];
+			}
+
+			T* from = data;
+			T* to = scratch;
+			for (size_t pass = 0; pass < PassCount; ++pass)
+			{
+				size_t* count = counts[pass];
+				if (count[(Lane::ToKey(from[0]) >> (pass * 8)) & 0xFF] == size)
+					continue;
+
+				size_t offset = 0;
+				for (size_t digit = 0; digit < 256; ++digit)
+				{
+					size_t digitCount = count[digit];
+					count[digit] = offset;
+					offset += digitCount;
+				}
+
+				for (size_t index = 0; index < size; ++index)
+					to[count[(Lane::ToKey(from[index]) >> (pass * 8)) & 0xFF]++] = from[index];
+
+				std::swap(from, to);
+			}
+
+			if (from != data)
+				::memcpy((void*)data, (const void*)from, size * sizeof(T));
+		}
+	}
+}
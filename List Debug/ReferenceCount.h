@@ -3,21 +3,89 @@
 #include<atomic>
 #include<cassert>
 
+/// <summary>
+/// <para>A reference policy tells how the owners of a shared block count themselves.</para>
+/// <para>It provides a Counter type, Increment(counter) returning true for the owner that was alone,</para>
+/// <para>Decrement(counter) returning true for the last owner, and Load(counter).</para>
+/// </summary>
+class AtomicReferencePolicy
+{
+public:
+	using Counter = std::atomic<int>;
+
+private:
+	/// <summary>
+	/// <para>Reads back the value just written, which continues the release sequence of every earlier decrement,</para>
+	/// <para>so this synchronizes with them like an acquire fence would, and unlike a fence ThreadSanitizer sees it.</para>
+	/// </summary>
+	static void Acquire(const Counter& counter) { (void)counter.load(std::memory_order_acquire); }
+
+public:
+	/// <summary>
+	/// <para>A new owner is made from an existing one, which keeps the block alive, so the increment needs no ordering.</para>
+	/// <para>Only when the block was owned alone, the caller may touch it, it acquires what the owners that left did first.</para>
+	/// </summary>
+	static bool Increment(Counter& counter)
+	{
+		if (counter.fetch_add(1, std::memory_order_relaxed) != 1)
+			return false;
+
+		Acquire(counter);
+		return true;
+	}
+
+	/// <summary>
+	/// <para>Every owner publishes its uses of the block by the release, the last one acquires them all before destroying it.</para>
+	/// </summary>
+	static bool Decrement(Counter& counter)
+	{
+		if (counter.fetch_sub(1, std::memory_order_release) != 1)
+			return false;
+
+		Acquire(counter);
+		return true;
+	}
+
+	static int Load(const Counter& counter) { return counter.load(std::memory_order_acquire); }
+};
+
+/// <summary>
+/// <para>For lists that never leave their thread, a plain integer, without any locked instruction.</para>
+/// <para>Sharing such a list with another thread is a data race.</para>
+/// </summary>
+class LocalReferencePolicy
+{
+public:
+	using Counter = int;
+
+	static bool Increment(Counter& counter) { return ++counter == 2; }
+	static bool Decrement(Counter& counter) { return !--counter; }
+	static int Load(const Counter& counter) { return counter; }
+};
+
 namespace EscapistPrivate
 {
+	template<typename ReferencePolicy>
 	class ReferenceCount
 	{
 	private:
-		std::atomic<int> ref;
+		typename ReferencePolicy::Counter ref;
 
 	public:
 		ReferenceCount(const int& initialValue) :ref(initialValue) {}
 
-		void IncrementRef() { ref.fetch_add(1, std::memory_order::memory_order_acq_rel); }
-		void DecrementRef() { ref.fetch_sub(1, std::memory_order::memory_order_acq_rel); }
+		/// <summary>
+		/// <para>Returns true if the block was owned alone before, the caller is the only one to see that.</para>
+		/// </summary>
+		bool IncrementRef() { return ReferencePolicy::Increment(ref); }
+
+		/// <summary>
+		/// <para>Returns true if the caller was the last owner, the block is then its own.</para>
+		/// </summary>
+		bool DecrementRef() { return ReferencePolicy::Decrement(ref); }
 
-		const int& GetValue()const { return ref.load(std::memory_order::memory_order_acquire); }
+		int GetValue()const { return ReferencePolicy::Load(ref); }
 
 		bool IsShared()const { return GetValue() > 1; }
 	};
-}
\ No newline at end of file
+}
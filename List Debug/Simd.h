@@ -0,0 +1,228 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ESCAPIST_SIMD_X86 1
+#include<immintrin.h>
+#ifdef _MSC_VER
+#include<intrin.h>
+#else
+#include<cpuid.h>
+#endif
+#else
+#define ESCAPIST_SIMD_X86 0
+#endif
+
+namespace EscapistPrivate
+{
+	namespace Simd
+	{
+		inline unsigned CountTrailingZeros(unsigned mask)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return index;
+#else
+			unsigned count = 0;
+			for (; !(mask & 1); mask >>= 1)
+				++count;
+			return count;
+#endif
+		}
+
+		inline unsigned GetHighestBit(unsigned mask)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return 31 - __builtin_clz(mask);
+#elif defined(_MSC_VER)
+			unsigned long index;
+			_BitScanReverse(&index, mask);
+			return index;
+#else
+			unsigned bit = 0;
+			while (mask >>= 1)
+				++bit;
+			return bit;
+#endif
+		}
+
+		inline unsigned CountBits(unsigned mask)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_popcount(mask);
+#else
+			unsigned count = 0;
+			for (; mask; mask &= mask - 1)
+				++count;
+			return count;
+#endif
+		}
+
+#if ESCAPIST_SIMD_X86
+		inline bool HasAvx2()
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) // OSXSAVE and AVX
+				return false;
+			if ((_xgetbv(0) & 6) != 6) // The OS saves the YMM registers.
+				return false;
+			__cpuidex(info, 7, 0);
+			return info[1] & (1 << 5);
+#else
+			return false;
+#endif
+		}
+
+		/// <summary>
+		/// <para>The register operations every kernel is written against, one Vector per instruction set.</para>
+		/// <para>The AVX2 one and the kernels using it are compiled with target("avx2"), so they may only run after HasAvx2.</para>
+		/// </summary>
+		namespace Sse2
+		{
+			struct Vector
+			{
+				using Register = __m128i;
+				static constexpr size_t Bytes = 16;
+
+				static Register Load(const void* pointer) { return _mm_loadu_si128((const __m128i*)pointer); }
+				static Register Or(Register left, Register right) { return _mm_or_si128(left, right); }
+				static unsigned Mask(Register equal) { return (unsigned)_mm_movemask_epi8(equal); }
+				static void Store(void* pointer, Register value) { _mm_storeu_si128((__m128i*)pointer, value); }
+				static void StoreAligned(void* pointer, Register value) { _mm_store_si128((__m128i*)pointer, value); }
+				static void Stream(void* pointer, Register value) { _mm_stream_si128((__m128i*)pointer, value); }
+				static void Fence() { _mm_sfence(); }
+
+				static Register Broadcast(uint8_t value) { return _mm_set1_epi8((char)value); }
+				static Register Broadcast(uint16_t value) { return _mm_set1_epi16((short)value); }
+				static Register Broadcast(uint32_t value) { return _mm_set1_epi32((int)value); }
+				static Register Broadcast(uint64_t value) { return _mm_set1_epi64x((long long)value); }
+				static Register Broadcast(float value) { return _mm_castps_si128(_mm_set1_ps(value)); }
+				static Register Broadcast(double value) { return _mm_castpd_si128(_mm_set1_pd(value)); }
+
+				// The lane type only selects the comparison.
+				static Register Equal(Register left, Register right, uint8_t) { return _mm_cmpeq_epi8(left, right); }
+				static Register Equal(Register left, Register right, uint16_t) { return _mm_cmpeq_epi16(left, right); }
+				static Register Equal(Register left, Register right, uint32_t) { return _mm_cmpeq_epi32(left, right); }
+				static Register Equal(Register left, Register right, uint64_t)
+				{
+					Register equal = _mm_cmpeq_epi32(left, right); // SSE2 has no 64-bit compare, both halves must match.
+					return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+				}
+				static Register Equal(Register left, Register right, float) { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(left), _mm_castsi128_ps(right))); }
+				static Register Equal(Register left, Register right, double) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(left), _mm_castsi128_pd(right))); }
+			};
+		}
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+		namespace Avx2
+		{
+			struct Vector
+			{
+				using Register = __m256i;
+				static constexpr size_t Bytes = 32;
+
+				static Register Load(const void* pointer) { return _mm256_loadu_si256((const __m256i*)pointer); }
+				static Register Or(Register left, Register right) { return _mm256_or_si256(left, right); }
+				static unsigned Mask(Register equal) { return (unsigned)_mm256_movemask_epi8(equal); }
+				static void Store(void* pointer, Register value) { _mm256_storeu_si256((__m256i*)pointer, value); }
+				static void StoreAligned(void* pointer, Register value) { _mm256_store_si256((__m256i*)pointer, value); }
+				static void Stream(void* pointer, Register value) { _mm256_stream_si256((__m256i*)pointer, value); }
+				static void Fence() { _mm_sfence(); }
+
+				static Register Broadcast(uint8_t value) { return _mm256_set1_epi8((char)value); }
+				static Register Broadcast(uint16_t value) { return _mm256_set1_epi16((short)value); }
+				static Register Broadcast(uint32_t value) { return _mm256_set1_epi32((int)value); }
+				static Register Broadcast(uint64_t value) { return _mm256_set1_epi64x((long long)value); }
+				static Register Broadcast(float value) { return _mm256_castps_si256(_mm256_set1_ps(value)); }
+				static Register Broadcast(double value) { return _mm256_castpd_si256(_mm256_set1_pd(value)); }
+
+				static Register Equal(Register left, Register right, uint8_t) { return _mm256_cmpeq_epi8(left, right); }
+				static Register Equal(Register left, Register right, uint16_t) { return _mm256_cmpeq_epi16(left, right); }
+				static Register Equal(Register left, Register right, uint32_t) { return _mm256_cmpeq_epi32(left, right); }
+				static Register Equal(Register left, Register right, uint64_t) { return _mm256_cmpeq_epi64(left, right); }
+				static Register Equal(Register left, Register right, float) { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(left), _mm256_castsi256_ps(right), _CMP_EQ_OQ)); }
+				static Register Equal(Register left, Register right, double) { return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(left), _mm256_castsi256_pd(right), _CMP_EQ_OQ)); }
+			};
+		}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+		inline void GetCpuid(unsigned leaf, unsigned subleaf, unsigned registers[4])
+		{
+#ifdef _MSC_VER
+			__cpuidex((int*)registers, (int)leaf, (int)subleaf);
+#else
+			__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+		}
+
+		/// <summary>
+		/// <para>The largest data or unified cache described by the deterministic cache leaf, 4 on Intel, 0x8000001D on AMD.</para>
+		/// </summary>
+		inline size_t GetCacheLeafSize(unsigned leaf)
+		{
+			unsigned registers[4];
+			GetCpuid(leaf & 0x80000000, 0, registers);
+			if (registers[0] < leaf)
+				return 0;
+
+			size_t largest = 0;
+			for (unsigned subleaf = 0; subleaf < 16; ++subleaf)
+			{
+				GetCpuid(leaf, subleaf, registers);
+
+				unsigned type = registers[0] & 0x1F;
+				if (!type)
+					break;
+				if (type == 2) // Instruction cache
+					continue;
+
+				size_t ways = ((registers[1] >> 22) & 0x3FF) + 1;
+				size_t partitions = ((registers[1] >> 12) & 0x3FF) + 1;
+				size_t lineSize = (registers[1] & 0xFFF) + 1;
+				size_t sets = (size_t)registers[2] + 1;
+
+				size_t cacheSize = ways * partitions * lineSize * sets;
+				if (cacheSize > largest)
+					largest = cacheSize;
+			}
+			return largest;
+		}
+#endif
+
+		/// <summary>
+		/// <para>The size of the last level cache, read once from CPUID, 8 MiB when it can't be told.</para>
+		/// </summary>
+		inline size_t GetLastLevelCacheSize()
+		{
+			static const size_t cacheSize = []
+			{
+				size_t size = 0;
+#if ESCAPIST_SIMD_X86
+				size = GetCacheLeafSize(4);
+				if (!size)
+					size = GetCacheLeafSize(0x8000001D);
+#endif
+				return size ? size : (size_t)8 << 20;
+			}();
+			return cacheSize;
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include"Simd.h"
+
+
+namespace EscapistPrivate
+{
+	namespace Simd
+	{
+		/// <summary>
+		/// <para>Below this many bytes, assigning element by element is cheaper than building the pattern.</para>
+		/// </summary>
+		static constexpr size_t MinimumFillBytes = 64;
+
+		/// <summary>
+		/// <para>The largest chunk the doubling fill copies at once, small enough to stay in the first level cache.</para>
+		/// </summary>
+		static constexpr size_t MaximumFillChunk = 4096;
+
+		/// <summary>
+		/// <para>Fill by copying the already filled front over the rest, twice as much each time.</para>
+		/// <para>Works for any element size, memcpy does the vector stores.</para>
+		/// </summary>
+		inline void FillDoubling(unsigned char* dest, size_t bytes, const unsigned char* element, size_t elementSize)
+		{
+			::memcpy(dest, element, elementSize);
+
+			size_t filled = elementSize;
+			size_t chunk = elementSize;
+			while (filled < bytes)
+			{
+				size_t copyBytes = chunk < bytes - filled ? chunk : bytes - filled;
+				::memcpy(dest + filled, dest, copyBytes);
+				filled += copyBytes;
+
+				if (chunk * 2 <= MaximumFillChunk)
+					chunk *= 2;
+			}
+		}
+
+#if ESCAPIST_SIMD_X86
+		namespace Sse2
+		{
+#include"SimdFillKernel.inl"
+		}
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+		namespace Avx2
+		{
+#include"SimdFillKernel.inl"
+		}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+		struct FillKernel
+		{
+			void(*fillPattern)(unsigned char*, size_t, const unsigned char*, size_t, bool);
+			size_t vectorBytes;
+
+			static const FillKernel& Get()
+			{
+				static const FillKernel kernel = HasAvx2() ? FillKernel{ &Avx2::FillPattern, 32 } : FillKernel{ &Sse2::FillPattern, 16 };
+				return kernel;
+			}
+		};
+#endif
+
+		/// <summary>
+		/// <para>Fill [count] elements of [elementSize] bytes at [dest] with the bytes of [element].</para>
+		/// <para>An element of one repeated byte, zero included, is a memset. Sizes dividing the vector width are broadcast stores,</para>
+		/// <para>streamed when the fill is larger than the last level cache. Any other size doubles with memcpy.</para>
+		/// </summary>
+		inline void Fill(void* dest, const void* element, size_t elementSize, size_t count)
+		{
+			unsigned char* bytes = (unsigned char*)dest;
+			const unsigned char* elementBytes = (const unsigned char*)element;
+			size_t totalBytes = elementSize * count;
+
+			size_t index = 1;
+			while (index < elementSize && elementBytes[index] == elementBytes[0])
+				++index;
+			if (index == elementSize)
+			{
+				::memset(bytes, elementBytes[0], totalBytes);
+				return;
+			}
+
+#if ESCAPIST_SIMD_X86
+			const FillKernel& kernel = FillKernel::Get();
+			if (!(kernel.vectorBytes % elementSize) && totalBytes >= kernel.vectorBytes)
+			{
+				kernel.fillPattern(bytes, totalBytes, elementBytes, elementSize, totalBytes > GetLastLevelCacheSize());
+				return;
+			}
+#endif
+			FillDoubling(bytes, totalBytes, elementBytes, elementSize);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+// The fill kernel over one Vector, included by SimdFill.h once per instruction set.
+// Each copy is compiled under the target options of its instruction set, so it may only be called after the CPUID check.
+
+/// <summary>
+/// <para>Fill [bytes] bytes with [element] repeated, the element size divides Vector::Bytes and bytes is at least Vector::Bytes.</para>
+/// <para>One unaligned store covers the head and one the tail, the body is aligned, streamed past the cache when [nonTemporal].</para>
+/// </summary>
+inline void FillPattern(unsigned char* dest, size_t bytes, const unsigned char* element, size_t elementSize, bool nonTemporal)
+{
+	// Two vectors of the element repeated, so a vector starting at any phase is a plain load from it.
+	alignas(Vector::Bytes) unsigned char pattern[Vector::Bytes * 2];
+	::memcpy(pattern, element, elementSize);
+	for (size_t filled = elementSize; filled < sizeof(pattern); filled *= 2) // Element sizes dividing a vector are powers of two.
+		::memcpy(pattern + filled, pattern, filled);
+
+	Vector::Store(dest, Vector::Load(pattern));
+
+	size_t headBytes = Vector::Bytes - ((uintptr_t)dest & (Vector::Bytes - 1));
+	Vector::Register body = Vector::Load(pattern + headBytes % elementSize);
+
+	unsigned char* current = dest + headBytes;
+	unsigned char* end = dest + bytes;
+	if (nonTemporal)
+	{
+		for (; current + Vector::Bytes * 4 <= end; current += Vector::Bytes * 4)
+		{
+			Vector::Stream(current, body);
+			Vector::Stream(current + Vector::Bytes, body);
+			Vector::Stream(current + Vector::Bytes * 2, body);
+			Vector::Stream(current + Vector::Bytes * 3, body);
+		}
+		for (; current + Vector::Bytes <= end; current += Vector::Bytes)
+			Vector::Stream(current, body);
+		Vector::Fence();
+	}
+	else
+	{
+		for (; current + Vector::Bytes * 4 <= end; current += Vector::Bytes * 4)
+		{
+			Vector::StoreAligned(current, body);
+			Vector::StoreAligned(current + Vector::Bytes, body);
+			Vector::StoreAligned(current + Vector::Bytes * 2, body);
+			Vector::StoreAligned(current + Vector::Bytes * 3, body);
+		}
+		for (; current + Vector::Bytes <= end; current += Vector::Bytes)
+			Vector::StoreAligned(current, body);
+	}
+
+	if (current < end)
+		Vector::Store(end - Vector::Bytes, Vector::Load(pattern + (bytes - Vector::Bytes) % elementSize));
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<type_traits>
+#include"Simd.h"
+
+
+namespace EscapistPrivate
+{
+	namespace Simd
+	{
+		static constexpr size_t NotFound = (size_t)-1;
+
+		/// <summary>
+		/// <para>Below this many elements, the scalar loop wins over the dispatch and the vector setup.</para>
+		/// </summary>
+		static constexpr size_t MinimumSize = 16;
+
+		/// <summary>
+		/// <para>IndexOfAny keeps one broadcast register per value, larger sets fall back to the scalar loop.</para>
+		/// </summary>
+		static constexpr size_t MaximumValues = 8;
+
+		/// <summary>
+		/// <para>The lane a Pod type is compared as: integers, enumerations and pointers bitwise, float and double as floating point.</para>
+		/// <para>Other Pod types, like user structs with their own operator==, keep the scalar loop.</para>
+		/// </summary>
+		template<typename T, typename = void>
+		struct SearchLane
+		{
+			static constexpr bool Enable = false;
+		};
+
+		template<typename T>
+		struct SearchLane<T, typename std::enable_if<(std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) &&
+			(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>::type>
+		{
+			static constexpr bool Enable = true;
+			using Lane = std::conditional_t<sizeof(T) == 1, uint8_t,
+				std::conditional_t<sizeof(T) == 2, uint16_t,
+				std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+		};
+
+		template<>
+		struct SearchLane<float>
+		{
+			static constexpr bool Enable = true;
+			using Lane = float;
+		};
+
+		template<>
+		struct SearchLane<double>
+		{
+			static constexpr bool Enable = true;
+			using Lane = double;
+		};
+
+		namespace Scalar
+		{
+			template<typename Lane>
+			size_t IndexOf(const Lane* data, size_t size, Lane value)
+			{
+				for (size_t index = 0; index < size; ++index)
+					if (data[index] == value)
+						return index;
+				return NotFound;
+			}
+
+			template<typename Lane>
+			size_t LastIndexOf(const Lane* data, size_t size, Lane value)
+			{
+				for (size_t index = size; index > 0; --index)
+					if (data[index - 1] == value)
+						return index - 1;
+				return NotFound;
+			}
+
+			template<typename Lane>
+			size_t Count(const Lane* data, size_t size, Lane value)
+			{
+				size_t count = 0;
+				for (size_t index = 0; index < size; ++index)
+					count += data[index] == value;
+				return count;
+			}
+
+			template<typename Lane>
+			size_t IndexOfAny(const Lane* data, size_t size, const Lane* values, size_t valueCount)
+			{
+				for (size_t index = 0; index < size; ++index)
+					for (size_t value = 0; value < valueCount; ++value)
+						if (data[index] == values[value])
+							return index;
+				return NotFound;
+			}
+		}
+
+#if ESCAPIST_SIMD_X86
+		namespace Sse2
+		{
+#include"SimdSearchKernel.inl"
+		}
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+		namespace Avx2
+		{
+#include"SimdSearchKernel.inl"
+		}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
+
+		/// <summary>
+		/// <para>The kernels of one lane type, picked once by CPUID: AVX2, else SSE2, else the scalar loops.</para>
+		/// </summary>
+		template<typename Lane>
+		struct SearchKernels
+		{
+			size_t(*indexOf)(const Lane*, size_t, Lane);
+			size_t(*lastIndexOf)(const Lane*, size_t, Lane);
+			size_t(*count)(const Lane*, size_t, Lane);
+			size_t(*indexOfAny)(const Lane*, size_t, const Lane*, size_t);
+
+			static SearchKernels Select()
+			{
+#if ESCAPIST_SIMD_X86
+				if (HasAvx2())
+					return { &Avx2::IndexOf<Lane>, &Avx2::LastIndexOf<Lane>, &Avx2::Count<Lane>, &Avx2::IndexOfAny<Lane> };
+				return { &Sse2::IndexOf<Lane>, &Sse2::LastIndexOf<Lane>, &Sse2::Count<Lane>, &Sse2::IndexOfAny<Lane> };
+#else
+				return { &Scalar::IndexOf<Lane>, &Scalar::LastIndexOf<Lane>, &Scalar::Count<Lane>, &Scalar::IndexOfAny<Lane> };
+#endif
+			}
+
+			static const SearchKernels& Get()
+			{
+				static const SearchKernels kernels = Select();
+				return kernels;
+			}
+		};
+
+		template<typename T>
+		typename SearchLane<T>::Lane ToLane(const T& value)
+		{
+			typename SearchLane<T>::Lane lane;
+			::memcpy((void*)&lane, (const void*)&value, sizeof(T));
+			return lane;
+		}
+
+		template<typename T>
+		size_t IndexOf(const T* data, size_t size, const T& value)
+		{
+			using Lane = typename SearchLane<T>::Lane;
+			if (size < MinimumSize)
+				return Scalar::IndexOf((const Lane*)data, size, ToLane(value));
+			return SearchKernels<Lane>::Get().indexOf((const Lane*)data, size, ToLane(value));
+		}
+
+		template<typename T>
+		size_t LastIndexOf(const T* data, size_t size, const T& value)
+		{
+			using Lane = typename SearchLane<T>::Lane;
+			if (size < MinimumSize)
+				return Scalar::LastIndexOf((const Lane*)data, size, ToLane(value));
+			return SearchKernels<Lane>::Get().lastIndexOf((const Lane*)data, size, ToLane(value));
+		}
+
+		template<typename T>
+		size_t Count(const T* data, size_t size, const T& value)
+		{
+			using Lane = typename SearchLane<T>::Lane;
+			if (size < MinimumSize)
+				return Scalar::Count((const Lane*)data, size, ToLane(value));
+			return SearchKernels<Lane>::Get().count((const Lane*)data, size, ToLane(value));
+		}
+
+		template<typename T>
+		size_t IndexOfAny(const T* data, size_t size, const T* values, size_t valueCount)
+		{
+			using Lane = typename SearchLane<T>::Lane;
+			if (size < MinimumSize || valueCount > MaximumValues)
+				return Scalar::IndexOfAny((const Lane*)data, size, (const Lane*)values, valueCount);
+			return SearchKernels<Lane>::Get().indexOfAny((const Lane*)data, size, (const Lane*)values, valueCount);
+		}
+	}
+}
@@ -0,0 +1,104 @@
+// The search kernels over one Vector, included by SimdSearch.h once per instruction set.
+// Each copy is compiled under the target options of its instruction set, so it may only be called after the CPUID check.
+
+template<typename Lane>
+size_t IndexOf(const Lane* data, size_t size, Lane value)
+{
+	constexpr size_t Step = Vector::Bytes / sizeof(Lane);
+
+	Vector::Register needle = Vector::Broadcast(value);
+
+	size_t index = 0;
+	for (; index + Step * 4 <= size; index += Step * 4)
+	{
+		Vector::Register equal0 = Vector::Equal(Vector::Load(data + index), needle, value);
+		Vector::Register equal1 = Vector::Equal(Vector::Load(data + index + Step), needle, value);
+		Vector::Register equal2 = Vector::Equal(Vector::Load(data + index + Step * 2), needle, value);
+		Vector::Register equal3 = Vector::Equal(Vector::Load(data + index + Step * 3), needle, value);
+
+		if (Vector::Mask(Vector::Or(Vector::Or(equal0, equal1), Vector::Or(equal2, equal3)))) // One test for four vectors, then find which.
+		{
+			unsigned mask;
+			if ((mask = Vector::Mask(equal0)))
+				return index + CountTrailingZeros(mask) / sizeof(Lane);
+			if ((mask = Vector::Mask(equal1)))
+				return index + Step + CountTrailingZeros(mask) / sizeof(Lane);
+			if ((mask = Vector::Mask(equal2)))
+				return index + Step * 2 + CountTrailingZeros(mask) / sizeof(Lane);
+			return index + Step * 3 + CountTrailingZeros(Vector::Mask(equal3)) / sizeof(Lane);
+		}
+	}
+
+	for (; index + Step <= size; index += Step)
+	{
+		unsigned mask = Vector::Mask(Vector::Equal(Vector::Load(data + index), needle, value));
+		if (mask)
+			return index + CountTrailingZeros(mask) / sizeof(Lane);
+	}
+
+	size_t found = Scalar::IndexOf(data + index, size - index, value);
+	return found == NotFound ? NotFound : index + found;
+}
+
+template<typename Lane>
+size_t LastIndexOf(const Lane* data, size_t size, Lane value)
+{
+	constexpr size_t Step = Vector::Bytes / sizeof(Lane);
+
+	Vector::Register needle = Vector::Broadcast(value);
+
+	size_t index = size;
+	for (; index >= Step; index -= Step)
+	{
+		unsigned mask = Vector::Mask(Vector::Equal(Vector::Load(data + index - Step), needle, value));
+		if (mask)
+			return index - Step + GetHighestBit(mask) / sizeof(Lane);
+	}
+
+	return Scalar::LastIndexOf(data, index, value);
+}
+
+template<typename Lane>
+size_t Count(const Lane* data, size_t size, Lane value)
+{
+	constexpr size_t Step = Vector::Bytes / sizeof(Lane);
+
+	Vector::Register needle = Vector::Broadcast(value);
+
+	size_t bits = 0; // Every matching lane sets sizeof(Lane) bits of the byte mask.
+	size_t index = 0;
+	for (; index + Step <= size; index += Step)
+		bits += CountBits(Vector::Mask(Vector::Equal(Vector::Load(data + index), needle, value)));
+
+	return bits / sizeof(Lane) + Scalar::Count(data + index, size - index, value);
+}
+
+template<typename Lane>
+size_t IndexOfAny(const Lane* data, size_t size, const Lane* values, size_t valueCount)
+{
+	constexpr size_t Step = Vector::Bytes / sizeof(Lane);
+
+	if (!valueCount)
+		return NotFound;
+
+	Vector::Register needles[MaximumValues];
+	for (size_t value = 0; value < valueCount; ++value)
+		needles[value] = Vector::Broadcast(values[value]);
+
+	size_t index = 0;
+	for (; index + Step <= size; index += Step)
+	{
+		Vector::Register elements = Vector::Load(data + index);
+
+		Vector::Register equal = Vector::Equal(elements, needles[0], values[0]);
+		for (size_t value = 1; value < valueCount; ++value)
+			equal = Vector::Or(equal, Vector::Equal(elements, needles[value], values[value]));
+
+		unsigned mask = Vector::Mask(equal);
+		if (mask)
+			return index + CountTrailingZeros(mask) / sizeof(Lane);
+	}
+
+	size_t found = Scalar::IndexOfAny(data + index, size - index, values, valueCount);
+	return found == NotFound ? NotFound : index + found;
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<functional>
+#include<type_traits>
+#if defined(_MSC_VER)
+#include<intrin.h>
+#endif
+#include"List.h"
+
+enum class SortedListLayout :short
+{
+	Sorted, // Binary search over the sorted elements themselves, nothing more is stored.
+	Eytzinger // A second copy in breadth-first order, searched level by level, rebuilt on every change.
+};
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>A hint only, an address past the end is never dereferenced.</para>
+	/// </summary>
+	inline void PrefetchRead(uintptr_t address)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch((const void*)address);
+#else
+		(void)address;
+#endif
+	}
+
+	inline size_t CountTrailingOnes(uint64_t value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return ~value ? (size_t)__builtin_ctzll(~value) : 64;
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		return _BitScanForward64(&index, ~value) ? (size_t)index : 64;
+#else
+		size_t count = 0;
+		for (; value & 1; value >>= 1)
+			++count;
+		return count;
+#endif
+	}
+}
+
+/// <summary>
+/// <para>A List kept sorted by [Compare], searched in O(log n) by LowerBound, UpperBound and Contains instead of scanned.</para>
+/// <para>The searches are branchless: the loop only moves a base by a comparison, which the compiler turns into a conditional move.</para>
+/// <para>InsertSorted takes a batch in any order, sorts it and merges it in one pass into one new block,</para>
+/// <para>so inserting k elements costs O(n + k log k) rather than k inserts of O(n) each.</para>
+/// <para>The Eytzinger layout keeps a second copy of the elements in the order of a breadth-first walk of the search tree,</para>
+/// <para>the first levels share a few cache lines and the next ones are prefetched, it pays off when the list outgrows the cache.</para>
+/// <para>It costs the elements and an index per element again, and a rebuild on every change, so it suits lists read far more than changed.</para>
+/// </summary>
+template<typename Type, typename Compare = std::less<Type>, SortedListLayout Layout = SortedListLayout::Sorted, typename AllocPolicy = MallocPolicy>
+class SortedList :private Compare // Empty base, so a stateless comparison costs nothing.
+{
+private:
+	using Self = SortedList<Type, Compare, Layout, AllocPolicy>;
+	using ListType = List<Type, AllocPolicy>;
+
+	static constexpr bool EnableEytzinger = Layout == SortedListLayout::Eytzinger;
+
+	ListType elements;
+	ListType tree; // Node k, from 1, at [k - 1], its children at 2k and 2k + 1.
+	List<size_t, AllocPolicy> ranks; // The index in [elements] of every node of [tree].
+
+	const Compare& GetCompare()const { return *this; }
+
+	/// <summary>
+	/// <para>Fill the subtree of node [node] in order from the sorted elements, from [index] on. Returns the index after its last one.</para>
+	/// </summary>
+	size_t BuildTree(const Type* sorted, size_t index, size_t node, Type* nodes, size_t* nodeRanks, size_t size)
+	{
+		if (node > size)
+			return index;
+
+		index = BuildTree(sorted, index, node * 2, nodes, nodeRanks, size);
+		Allocator<Type>::CopyConstruct(nodes + node - 1, sorted[index]);
+		nodeRanks[node - 1] = index;
+		return BuildTree(sorted, index + 1, node * 2 + 1, nodes, nodeRanks, size);
+	}
+
+	/// <summary>
+	/// <para>Every change of the elements ends here, the Eytzinger copy follows them.</para>
+	/// </summary>
+	void Rebuild()
+	{
+		if constexpr (EnableEytzinger)
+		{
+			size_t size = elements.GetSize();
+			ListType newTree(size, elements.GetAllocPolicy()); // Uninitialized, every node is constructed by BuildTree.
+			List<size_t, AllocPolicy> newRanks(size, ranks.GetAllocPolicy());
+
+			if (size)
+				BuildTree(elements.GetConstData(), 0, 1, newTree.GetData(), newRanks.GetData(), size);
+
+			tree = std::move(newTree);
+			ranks = std::move(newRanks);
+		}
+	}
+
+	/// <summary>
+	/// <para>Whether the search for [value] goes past [element]: for the lower bound every element before it, for the upper one every element not after it.</para>
+	/// </summary>
+	template<bool Upper>
+	bool IsPast(const Type& element, const Type& value)const { return Upper ? !GetCompare()(value, element) : GetCompare()(element, value); }
+
+	/// <summary>
+	/// <para>The node the search for [value] ends at, or 0 if it goes past every element.</para>
+	/// <para>The descent goes right past every node it goes past, the answer is the last node it went left at.</para>
+	/// </summary>
+	template<bool Upper>
+	size_t SearchTree(const Type& value)const
+	{
+		const Type* nodes = tree.GetConstData();
+		size_t size = tree.GetSize();
+
+		size_t node = 1;
+		while (node <= size)
+		{
+			EscapistPrivate::PrefetchRead((uintptr_t)nodes + (node * 16 - 1) * sizeof(Type)); // Four levels down.
+			node = node * 2 + IsPast<Upper>(nodes[node - 1], value);
+		}
+
+		// Drop the right turns taken after the last left one, then that left turn.
+		size_t turns = EscapistPrivate::CountTrailingOnes(node) + 1;
+		return turns < sizeof(size_t) * 8 ? node >> turns : 0;
+	}
+
+	/// <summary>
+	/// <para>The first index the search for [value] does not go past, over the sorted elements.</para>
+	/// </summary>
+	template<bool Upper>
+	size_t SearchSorted(const Type& value)const
+	{
+		const Type* data = elements.GetConstData();
+		size_t size = elements.GetSize();
+		if (!size)
+			return 0;
+
+		const Type* base = data;
+		while (size > 1)
+		{
+			size_t half = size / 2;
+			base += IsPast<Upper>(base[half], value) ? half : 0;
+			size -= half;
+		}
+		return (size_t)(base - data) + IsPast<Upper>(*base, value);
+	}
+
+	template<bool Upper>
+	size_t Search(const Type& value)const
+	{
+		if constexpr (EnableEytzinger)
+		{
+			size_t node = SearchTree<Upper>(value);
+			return node ? ranks.GetConstData()[node - 1] : elements.GetSize();
+		}
+		else
+			return SearchSorted<Upper>(value);
+	}
+
+	/// <summary>
+	/// <para>Sort a batch by [Compare], unless it already is, as the elements of a sorted feed usually are.</para>
+	/// <para>The ascending order of radix sorted types is List::Sort, their equal elements cannot be told apart.</para>
+	/// </summary>
+	void SortBatch(ListType& batch)const
+	{
+		const Type* data = batch.GetConstData();
+		if (std::is_sorted(data, data + batch.GetSize(), GetCompare()))
+			return;
+
+		if constexpr (std::is_same_v<Compare, std::less<Type>> && EscapistPrivate::ListCore<Type, AllocPolicy>::EnableRadixSort)
+		{
+			batch.Sort();
+			return;
+		}
+
+		Type* sorted = batch.GetData();
+		std::stable_sort(sorted, sorted + batch.GetSize(), GetCompare());
+	}
+
+public:
+	explicit SortedList(const Compare& compare = Compare(), const AllocPolicy& policy = AllocPolicy())
+		:Compare(compare), elements(policy), tree(policy), ranks(policy)
+	{}
+
+	/// <summary>
+	/// <para>The [count] elements at [values] in any order.</para>
+	/// </summary>
+	SortedList(const Type* values, size_t count, const Compare& compare = Compare(), const AllocPolicy& policy = AllocPolicy())
+		:Compare(compare), elements(values, count, policy), tree(policy), ranks(policy)
+	{
+		SortBatch(elements);
+		Rebuild();
+	}
+
+	/// <summary>
+	/// <para>The elements of [list] in any order, sharing its block when they are sorted already.</para>
+	/// </summary>
+	explicit SortedList(const ListType& list, const Compare& compare = Compare())
+		:Compare(compare), elements(list), tree(list.GetAllocPolicy()), ranks(list.GetAllocPolicy())
+	{
+		SortBatch(elements);
+		Rebuild();
+	}
+
+	/// <summary>
+	/// <para>Insert one element after the ones equal to it.</para>
+	/// </summary>
+	Self& Insert(const Type& value)
+	{
+		elements.Insert(UpperBound(value), value);
+		Rebuild();
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>Insert [count] elements in any order in one pass, each after the ones equal to it already in the list.</para>
+	/// </summary>
+	Self& InsertSorted(const Type* values, size_t count)
+	{
+		if (!count)
+			return *this;
+
+		ListType batch(values, count, elements.GetAllocPolicy());
+		SortBatch(batch);
+		elements.MergeSorted(batch, GetCompare());
+		Rebuild();
+		return *this;
+	}
+
+	Self& InsertSorted(const ListType& values)
+	{
+		if (values.IsEmpty())
+			return *this;
+
+		ListType batch(values);
+		SortBatch(batch);
+		elements.MergeSorted(batch, GetCompare());
+		Rebuild();
+		return *this;
+	}
+
+	Self& Delete(size_t index, size_t count)
+	{
+		elements.Delete(index, count);
+		Rebuild();
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>Delete the first element equal to [value], returns false if there is none.</para>
+	/// </summary>
+	bool Remove(const Type& value)
+	{
+		size_t index = IndexOf(value);
+		if (index == (size_t)-1)
+			return false;
+
+		Delete(index, 1);
+		return true;
+	}
+
+	Self& Empty()
+	{
+		elements.Empty();
+		Rebuild();
+		return *this;
+	}
+
+	/// <summary>
+	/// <para>The index of the first element not before [value], the size if there is none.</para>
+	/// </summary>
+	size_t LowerBound(const Type& value)const { return Search<false>(value); }
+
+	/// <summary>
+	/// <para>The index of the first element after [value], the size if there is none.</para>
+	/// </summary>
+	size_t UpperBound(const Type& value)const { return Search<true>(value); }
+
+	bool Contains(const Type& value)const
+	{
+		if constexpr (EnableEytzinger)
+		{
+			size_t node = SearchTree<false>(value);
+			return node && !GetCompare()(value, tree.GetConstData()[node - 1]);
+		}
+		else
+		{
+			size_t index = SearchSorted<false>(value);
+			return index < elements.GetSize() && !GetCompare()(value, elements.GetConstData()[index]);
+		}
+	}
+
+	/// <summary>
+	/// <para>The index of the first element equal to [value], -1 if there is none, like List::IndexOf.</para>
+	/// </summary>
+	size_t IndexOf(const Type& value)const
+	{
+		size_t index = LowerBound(value);
+		return index < elements.GetSize() && !GetCompare()(value, elements.GetConstData()[index]) ? index : -1;
+	}
+
+	bool IsExist(const Type& value)const { return Contains(value); }
+	size_t Count(const Type& value)const { return UpperBound(value) - LowerBound(value); }
+
+	bool IsEmpty()const { return elements.IsEmpty(); }
+
+	size_t GetSize()const { return elements.GetSize(); }
+	size_t GetCount()const { return elements.GetSize(); }
+	size_t GetLength()const { return elements.GetSize(); }
+
+	const Type* GetConstData()const { return elements.GetConstData(); }
+
+	/// <summary>
+	/// <para>The sorted elements as a List, copying it only shares the block.</para>
+	/// </summary>
+	const ListType& GetList()const { return elements; }
+};
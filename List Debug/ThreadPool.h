@@ -0,0 +1,198 @@
+#pragma once
+
+#include<atomic>
+#include<condition_variable>
+#include<cstddef>
+#include<deque>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>One call of ThreadPool::Run, its tasks are the indices [0, taskCount).</para>
+	/// </summary>
+	struct PoolJob
+	{
+		void (*invoke)(const void* function, size_t index);
+		const void* function;
+		std::atomic<size_t> remaining;
+	};
+
+	struct PoolTask
+	{
+		PoolJob* job;
+		size_t index;
+	};
+
+	/// <summary>
+	/// <para>The tasks of one worker. It takes them from the back, the freshest ones, thieves take from the front.</para>
+	/// </summary>
+	struct alignas(64) PoolQueue
+	{
+		std::mutex mutex;
+		std::deque<PoolTask> tasks;
+	};
+}
+
+/// <summary>
+/// <para>A work-stealing pool of threads for fork-join loops: Run(taskCount, task) calls task(index) for every index and waits.</para>
+/// <para>The tasks are dealt to the queues of the workers, a worker whose queue is empty steals from the others,</para>
+/// <para>and the calling thread works too while it waits, so a task may itself call Run without deadlocking the pool.</para>
+/// </summary>
+class ThreadPool
+{
+private:
+	using Job = EscapistPrivate::PoolJob;
+	using Task = EscapistPrivate::PoolTask;
+	using Queue = EscapistPrivate::PoolQueue;
+
+	std::unique_ptr<Queue[]> queues;
+	std::vector<std::thread> workers;
+	size_t queueCount;
+
+	std::atomic<size_t> pending;
+	std::atomic<size_t> nextQueue;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	bool stop;
+
+	/// <summary>
+	/// <para>Run one task, from queue [home] first, then stolen from the others. Returns false if every queue was empty.</para>
+	/// </summary>
+	bool RunOne(size_t home)
+	{
+		if (!pending.load(std::memory_order_relaxed))
+			return false;
+
+		for (size_t offset = 0; offset < queueCount; ++offset)
+		{
+			Queue& queue = queues[(home + offset) % queueCount];
+
+			Task task;
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (queue.tasks.empty())
+					continue;
+
+				if (!offset)
+				{
+					task = queue.tasks.back();
+					queue.tasks.pop_back();
+				}
+				else
+				{
+					task = queue.tasks.front();
+					queue.tasks.pop_front();
+				}
+			}
+
+			pending.fetch_sub(1, std::memory_order_relaxed);
+			task.job->invoke(task.job->function, task.index);
+			task.job->remaining.fetch_sub(1, std::memory_order_release);
+			return true;
+		}
+		return false;
+	}
+
+	void Work(size_t home)
+	{
+		for (;;)
+		{
+			if (RunOne(home))
+				continue;
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wake.wait(lock, [&] { return stop || pending.load(std::memory_order_relaxed); });
+			if (stop)
+				return;
+		}
+	}
+
+public:
+	/// <summary>
+	/// <para>[threadCount] threads work on a Run, counting the calling one, so the pool starts [threadCount] - 1 workers.</para>
+	/// </summary>
+	explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency())
+		:queueCount(threadCount > 1 ? threadCount - 1 : 1), pending(0), nextQueue(0), stop(false)
+	{
+		queues.reset(new Queue[queueCount]);
+		for (size_t index = 0; index + 1 < threadCount; ++index)
+			workers.emplace_back([this, index] { Work(index); });
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stop = true;
+		}
+		wake.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	/// <summary>
+	/// <para>The threads working on a Run, the calling one included.</para>
+	/// </summary>
+	size_t GetThreadCount()const { return workers.size() + 1; }
+
+	/// <summary>
+	/// <para>Call [task](index) for every index of [0, taskCount) on the pool and return once they are all done.</para>
+	/// </summary>
+	template<typename Function>
+	void Run(size_t taskCount, const Function& task)
+	{
+		if (!taskCount)
+			return;
+
+		if (workers.empty() || taskCount == 1)
+		{
+			for (size_t index = 0; index < taskCount; ++index)
+				task(index);
+			return;
+		}
+
+		Job job;
+		job.invoke = [](const void* function, size_t index) { (*(const Function*)function)(index); };
+		job.function = &task;
+		job.remaining.store(taskCount, std::memory_order_relaxed);
+
+		// Counted before they are queued, so a task is never taken before it is counted.
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			pending.fetch_add(taskCount, std::memory_order_relaxed);
+		}
+
+		// Consecutive tasks go to consecutive queues, each worker starts with its own share of the range.
+		size_t first = nextQueue.fetch_add(1, std::memory_order_relaxed);
+		for (size_t index = 0; index < taskCount; ++index)
+		{
+			Queue& queue = queues[(first + index) % queueCount];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back({ &job, index });
+		}
+		wake.notify_all();
+
+		while (job.remaining.load(std::memory_order_acquire))
+		{
+			if (!RunOne(first))
+				std::this_thread::yield();
+		}
+	}
+
+	/// <summary>
+	/// <para>The pool shared by every caller that does not bring its own, one thread per core.</para>
+	/// </summary>
+	static ThreadPool& GetDefault()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+};
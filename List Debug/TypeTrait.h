@@ -1,21 +1,24 @@
 #pragma once
 
 #include<cassert>
+#include<cstring>
 #include<memory>
+#include<type_traits>
+#include"SimdFill.h"
 
 enum class TypeTraitPattern :short
 {
 	Pod,
 	Generic,
-	NonDefault
+	NonDefault,
+	Relocatable
 };
 
+/// <summary>
+/// <para>Any trivially copyable type, builtin or a plain user struct, is copied and moved with memcpy.</para>
+/// </summary>
 template<typename T>
-constexpr bool IsComplex = !std::_Is_any_of_v<std::remove_cv_t<T>,
-	bool, char, signed char, unsigned char, wchar_t, char16_t, char32_t,
-	short, unsigned short, int, unsigned int, long, unsigned long, long long, unsigned long long,
-	float, double, long double,
-	void, std::nullptr_t>;
+constexpr bool IsComplex = !std::is_trivially_copyable_v<std::remove_cv_t<T>>;
 
 template<typename T>
 struct TypeTraitPatternDefiner
@@ -27,10 +30,16 @@ template<typename T>
 class TypeTrait
 {
 public:
+	/// <summary>
+	/// <para>Whether the elements may be moved around bitwise, by memmove or realloc, without running any constructor.</para>
+	/// </summary>
+	static constexpr bool IsRelocatable = true;
+
 	static void Copy(T* dest, const T* src, size_t size) { ::memcpy((void*)dest, (const void*)src, size * sizeof(T)); }
-	static void Move(T* dest, const T* src, size_t size) { ::memmove((void*)dest, (const void*)src, size * sizeof(T)); }
+	static void Move(T* dest, T* src, size_t size) { ::memmove((void*)dest, (const void*)src, size * sizeof(T)); }
 
 	static void Assign(T* dest, const T& val) { ::memcpy((void*)dest, (const void*)&val, sizeof(T)); }
+	static void Assign(T* dest, T&& val) { ::memcpy((void*)dest, (const void*)&val, sizeof(T)); }
 	static void Fill(T* dest, const T& val, size_t count)
 	{
 		for (; count > 0; --count, ++dest)
@@ -49,15 +58,15 @@ public:
 	}
 	static int Compare(const T* left, const T* right, size_t size)
 	{
-		int rtn;
-		for (; !(rtn = TypeTrait<T>::Equals(*left, *right)) && size > 0; ++left, ++right, --size);
+		int rtn = 0;
+		for (; size > 0 && !(rtn = TypeTrait<T>::Equals(*left, *right)); ++left, ++right, --size);
 		return rtn;
 	}
 
 	static size_t GetSize(const T* src)
 	{
 		size_t count(0);
-		while (!TypeTrait<T>::Equals(*src, T()))
+		for (; TypeTrait<T>::Equals(*src, T()); ++src)
 			++count;
 		return count;
 	}
@@ -78,12 +87,18 @@ namespace EscapistPrivate
 	class PodTypeTrait :public TypeTrait<T>
 	{
 	public:
+		static constexpr bool IsRelocatable = true;
+
 		static void Copy(T* dest, const T* src, size_t size) { ::memcpy((void*)dest, (const void*)src, size * sizeof(T)); }
-		static void Move(T* dest, const T* src, size_t size) { ::memmove((void*)dest, (const void*)src, size * sizeof(T)); }
+		static void Move(T* dest, T* src, size_t size) { ::memmove((void*)dest, (const void*)src, size * sizeof(T)); }
 
 		static void Assign(T* dest, const T& val) { ::memcpy((void*)dest, (const void*)&val, sizeof(T)); }
+		static void Assign(T* dest, T&& val) { ::memcpy((void*)dest, (const void*)&val, sizeof(T)); }
 		static void Fill(T* dest, const T& val, size_t count)
 		{
+			if (count * sizeof(T) >= Simd::MinimumFillBytes)
+				return Simd::Fill((void*)dest, (const void*)&val, sizeof(T), count);
+
 			for (; count > 0; --count, ++dest)
 				::memcpy((void*)dest, (const void*)&val, sizeof(T));
 		}
@@ -95,37 +110,58 @@ namespace EscapistPrivate
 		static size_t GetCount(const T* src) { return TypeTrait<T>::GetCount(src); }
 		static size_t GetLength(const T* src) { return TypeTrait<T>::GetLength(src); }
 
-		static void Destroy(T* ptr) {}
-		static void Destroy(T* ptr, size_t count) {}
+		static void Destroy(T*) {}
+		static void Destroy(T*, size_t) {}
 	};
 
 	template<typename T>
 	class GenericTypeTrait :public TypeTrait<T>
 	{
 	public:
+		static constexpr bool IsRelocatable = false;
+
 		static void Copy(T* dest, const T* src, size_t size)
 		{
-			for (; size > 0; ++dest, ++src)
-				new(dest)T(*src);
+			if constexpr (std::is_copy_constructible_v<T>)
+			{
+				for (; size > 0; ++dest, ++src, --size)
+					new(dest)T(*src);
+			}
+			else
+				assert(!size); // A list of move-only elements is never shared, so its elements are never copied.
 		}
-		static void Move(T* dest, const T* src, size_t size)
+
+		/// <summary>
+		/// <para>Move-construct every element at its new place and destroy the source, the ranges may overlap.</para>
+		/// </summary>
+		static void Move(T* dest, T* src, size_t size)
 		{
-			if (dest <= src || dest >= (src + size))
+			if (dest == src) // Moving onto itself would destroy the element it just built.
+				return;
+
+			if (dest < src || dest >= (src + size))
 			{
-				for (; size > 0; ++dest, ++src)
-					new(dest)T(*src);
+				for (; size > 0; ++dest, ++src, --size)
+				{
+					new(dest)T(std::move(*src));
+					src->~T();
+				}
 			}
 			else
 			{
 				dest = dest + size - 1;
 				src = src + size - 1;
 
-				for (; size > 0; --dest, --src)
-					new(dest)T(*src);
+				for (; size > 0; --dest, --src, --size)
+				{
+					new(dest)T(std::move(*src));
+					src->~T();
+				}
 			}
 		}
 
 		static void Assign(T* dest, const T& val) { new(dest)T(val); }
+		static void Assign(T* dest, T&& val) { new(dest)T(std::move(val)); }
 		static void Fill(T* dest, const T& val, size_t count)
 		{
 			for (; count > 0; --count, ++dest)
@@ -148,6 +184,21 @@ namespace EscapistPrivate
 	};
 }
 
+namespace EscapistPrivate
+{
+	/// <summary>
+	/// <para>Copied and destroyed like a generic type, but moved bitwise, e.g. std::unique_ptr or a COW string.</para>
+	/// </summary>
+	template<typename T>
+	class RelocatableTypeTrait :public GenericTypeTrait<T>
+	{
+	public:
+		static constexpr bool IsRelocatable = true;
+
+		static void Move(T* dest, T* src, size_t size) { ::memmove((void*)dest, (const void*)src, size * sizeof(T)); }
+	};
+}
+
 template<typename T, typename = void>
 struct TypeTraitPatternSelector
 {
@@ -172,7 +223,14 @@ template<typename T>
 struct TypeTraitPatternSelector<T,
 	typename std::enable_if<(TypeTraitPatternDefiner<T>::Pattern == TypeTraitPattern::NonDefault)>::type>
 {
-	using TypeTrait = TypeTrait<T>;
+	using TypeTrait = ::TypeTrait<T>;
+};
+
+template<typename T>
+struct TypeTraitPatternSelector<T,
+	typename std::enable_if<(TypeTraitPatternDefiner<T>::Pattern == TypeTraitPattern::Relocatable)>::type>
+{
+	using TypeTrait = EscapistPrivate::RelocatableTypeTrait<T>;
 };
 
 #define DefineTypeTrait(T,P) \
@@ -184,6 +242,7 @@ struct TypeTraitPatternDefiner<T>\
 #define DefinePodTypeTrait(T) DefineTypeTrait(T,TypeTraitPattern::Pod)
 #define DefineGenericTypeTrait(T) DefineTypeTrait(T,TypeTraitPattern::Generic)
 #define DefineNonDefaultTypeTrait(T) DefineTypeTrait(T,TypeTraitPattern::NonDefault)
+#define DefineRelocatableTypeTrait(T) DefineTypeTrait(T,TypeTraitPattern::Relocatable)
 
 DefinePodTypeTrait(bool);
 DefinePodTypeTrait(char);
@@ -202,4 +261,16 @@ DefinePodTypeTrait(long long);
 DefinePodTypeTrait(unsigned long long);
 DefinePodTypeTrait(float);
 DefinePodTypeTrait(double);
-DefinePodTypeTrait(long double);
\ No newline at end of file
+DefinePodTypeTrait(long double);
+
+template<typename T>
+struct TypeTraitPatternDefiner<std::unique_ptr<T>>
+{
+	static const TypeTraitPattern Pattern = TypeTraitPattern::Relocatable;
+};
+
+template<typename T>
+struct TypeTraitPatternDefiner<std::shared_ptr<T>>
+{
+	static const TypeTraitPattern Pattern = TypeTraitPattern::Relocatable;
+};
\ No newline at end of file